@@ -0,0 +1,66 @@
+#include "../src/ast/cache.h"
+#include "../src/ast/dump.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace ast;
+
+int main(int argc, const char **argv) {
+  size_t size = 8 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  COMPILED_FILES_PATH = (std::filesystem::temp_directory_path() / "bedrock_bench_cache").string() + "/";
+  string path = bench::write_temp_source("ast_cache.br", bench::synthetic_source(size));
+
+  // Lexing and parsing from the file, which is what every run pays without the cache.
+  shared_ptr<ModuleStmt> parsed;
+  double parse = bench::best_of(3, [&]() {
+    parsed = nullptr;
+    parsed = parser::parse(path)->entry;
+  });
+
+  double store = bench::best_of(1, [&]() { store_cached_module(*parsed); });
+  size_t snapshot_bytes = std::filesystem::file_size(cache_path(path));
+
+  // Opening the source, hashing it and rebuilding the top level of the module from the mapped snapshot.
+  shared_ptr<ModuleStmt> loaded;
+  double load = bench::best_of(3, [&]() {
+    loaded = nullptr;
+    loaded = load_cached_module(lexer::SourceFile::open(path));
+  });
+
+  // Decoding every function body as well, which is what checking a module which changed asks for. Only the bodies of
+  // settled modules are never decoded, see analysis::tc_program.
+  double bodies = bench::best_of(1, [&]() {
+    for (Stmt *stmt : loaded->body) {
+      if (stmt->kind == FN_DECL_STMT) {
+        parser::fn_body(static_cast<FnDeclStmt *>(stmt));
+      }
+    }
+  });
+
+  if (!loaded || debug_str(loaded.get()) != debug_str(parsed.get())) {
+    std::cout << "module loaded from the cache differs from the parsed module\n";
+    return 1;
+  }
+
+  // Any edit to the source must invalidate the snapshot.
+  bench::write_temp_source("ast_cache.br", bench::synthetic_source(size) + "\n");
+  if (load_cached_module(lexer::SourceFile::open(path))) {
+    std::cout << "stale snapshot was loaded after the source changed\n";
+    return 1;
+  }
+
+  printf("%.1f MB source, %.1f MB snapshot\n", size / 1048576.0, snapshot_bytes / 1048576.0);
+  printf("%-8s %8.1f ms\n", "parse", parse * 1000);
+  printf("%-8s %8.1f ms\n", "store", store * 1000);
+  printf("%-8s %8.1f ms\n", "load", load * 1000);
+  printf("%-8s %8.1f ms\n", "bodies", bodies * 1000);
+  printf("%-8s %8.1f ms\n", "cached", (load + bodies) * 1000);
+  printf("the whole module is %.1fx faster from the cache than parsed, its top level alone %.1fx\n",
+         parse / (load + bodies), parse / load);
+  return 0;
+}
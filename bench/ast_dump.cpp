@@ -0,0 +1,62 @@
+#include "../src/ast/dump.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace ast;
+
+// Counts what is written without keeping it, like a terminal or pipe that is drained as fast as it is filled.
+struct CountingBuf : public std::streambuf {
+  size_t bytes = 0;
+
+  std::streamsize xsputn(const char *, std::streamsize n) {
+    bytes += n;
+    return n;
+  }
+
+  int overflow(int c) {
+    bytes++;
+    return c;
+  }
+};
+
+int main(int argc, const char **argv) {
+  size_t size = 8 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  auto program = parser::parse(bench::write_temp_source("ast_dump.br", bench::synthetic_source(size)));
+  if (!program) {
+    return 1;
+  }
+
+  // The whole dump built in memory before it is printed, which is what --ast did before dumps were streamed.
+  size_t buffered_bytes = 0;
+  double buffered = bench::best_of(3, [&]() { buffered_bytes = debug_str(program.get()).size(); });
+
+  CountingBuf text_buf, json_buf;
+  std::ostream text_out{&text_buf}, json_out{&json_buf};
+
+  double text = bench::best_of(3, [&]() {
+    TextDumper out{text_out};
+    program->dump(out);
+  });
+
+  double json = bench::best_of(3, [&]() {
+    JsonDumper out{json_out};
+    program->entry->dump(out);
+  });
+
+  if (text_buf.bytes != buffered_bytes * 3) {
+    std::cout << "streamed text dump differs in size from the buffered dump\n";
+    return 1;
+  }
+
+  printf("%.1f MB source, %.1f MB text dump, %.1f MB json dump\n", size / 1048576.0, buffered_bytes / 1048576.0,
+         json_buf.bytes / 3 / 1048576.0);
+  printf("%-10s %8.1f ms %10.1f MB held\n", "buffered", buffered * 1000, buffered_bytes / 1048576.0);
+  printf("%-10s %8.1f ms %10.1f MB held\n", "text", text * 1000, 0.0);
+  printf("%-10s %8.1f ms %10.1f MB held\n", "json", json * 1000, 0.0);
+  return 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/bedrock.h"
+
+// Benchmarks link against every compiler object except becrock.o so the flag globals are defined here instead. Each
+// benchmark is a single translation unit which includes this header once.
+bool COLORS_ENABLED = false;
+bool DISPLAY_AST = false;
+bool DISPLAY_TOKENS = false;
+bool DISPLAY_TYPEINFO = false;
+bool DUMP_JSON = false;
+bool DISABLE_BOUND_CHECKING = false;
+bool LAZY_FN_BODIES = false;
+bool AST_CACHE = false;
+string COMPILED_FILES_PATH = ".builds/";
+
+/// @brief Shared helpers for the programs inside bench/. Built and run with `make bench`.
+namespace bench {
+
+/// @brief Runs fn `runs` times and returns the fastest wall clock time in seconds.
+template <typename Fn> double best_of(size_t runs, Fn fn) {
+  double best = 0;
+
+  for (size_t i = 0; i < runs; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (i == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+
+  return best;
+}
+
+inline double mb_per_s(size_t bytes, double seconds) {
+  return (double)bytes / (1024.0 * 1024.0) / seconds;
+}
+
+/// @brief Builds a deterministic bedrock program of roughly `target_bytes` bytes. The output mixes comments, strings,
+/// numbers, keywords and operators in roughly the proportions found in hand written code.
+inline string synthetic_source(size_t target_bytes) {
+  string src;
+  src.reserve(target_bytes + 512);
+
+  for (size_t i = 0; src.size() < target_bytes; i++) {
+    string n = to_string(i);
+
+    src += "// generated function " + n + " computes a value from its inputs\n";
+    src += "fn compute_" + n + " (a: Number, b: &Number) -> Number {\n";
+    src += "  let x_" + n + " = a * " + n + " + 3.5 / (a - 7) % 2;\n";
+    src += "  const label_" + n + " = \"value of compute_" + n + "\";\n";
+    src += "  @log(@str(x_" + n + "));\n";
+    src += "  return x_" + n + ";\n";
+    src += "}\n\n";
+  }
+
+  return src;
+}
+
+/// @brief Shape of a program built by write_synthetic_project.
+struct ProjectShape {
+  size_t modules = 16;   // module i imports modules 2i + 1 and 2i + 2, so imports form a binary tree
+  size_t functions = 64; // functions per module
+  size_t structs = 16;   // structs per module, taken as parameters by the functions
+  size_t depth = 12;     // nesting depth of the expression computed by every function
+};
+
+/// @brief Builds the expression `depth` parentheses deep which every generated function computes from a and b.
+inline string nested_expr(size_t depth, size_t seed) {
+  static const char *OPS[] = {" + ", " * ", " - ", " / "};
+
+  if (depth == 0) {
+    return seed % 3 == 0 ? "a" : seed % 3 == 1 ? "b" : to_string(seed % 97) + ".5";
+  }
+
+  return "(" + nested_expr(depth - 1, seed * 31 + 7) + OPS[seed % 4] + nested_expr(0, seed + depth) + ")";
+}
+
+/// @brief Writes a deterministic project of the given shape into a fresh directory inside the system temp directory
+/// and returns the path of its entry module. Everything in it lexes, parses, type checks and compiles.
+inline string write_synthetic_project(const string &name, const ProjectShape &shape) {
+  auto dir = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  for (size_t m = 0; m < shape.modules; m++) {
+    string src;
+    for (size_t child : {2 * m + 1, 2 * m + 2}) {
+      if (child < shape.modules) {
+        src += "import(\"m" + to_string(child) + "\") as m" + to_string(child) + ";\n";
+      }
+    }
+
+    for (size_t s = 0; s < shape.structs; s++) {
+      string n = to_string(s);
+      src += "\nstruct Shape_" + n + " {\n  pub width: Number;\n  pub height: Number;\n  static count: Number;\n}\n";
+    }
+
+    src += "\nconst scale = " + to_string(m + 1) + ";\n";
+
+    for (size_t f = 0; f < shape.functions; f++) {
+      string n = to_string(f);
+      string param = shape.structs > 0 ? "shape: Shape_" + to_string(f % shape.structs) + ", " : "";
+
+      src += "\nfn compute_" + n + " (" + param + "a: Number, b: Number) -> Number {\n";
+      src += "  let x = " + nested_expr(shape.depth, m * shape.functions + f) + ";\n";
+      src += "  let y = x * scale - a;\n";
+      src += "  return y + " + n + ";\n}\n";
+    }
+
+    if (m == 0) {
+      src += "\nfn main () {\n  let x = 1;\n}\n";
+    }
+
+    std::ofstream file(dir / ("m" + to_string(m) + ".br"), std::ios::out | std::ios::trunc | std::ios::binary);
+    file << src;
+  }
+
+  return (dir / "m0.br").string();
+}
+
+/// @brief Writes src into the system temp directory and returns the path of the written file.
+inline string write_temp_source(const string &name, const string &src) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  file << src;
+  return path.string();
+}
+}; // namespace bench
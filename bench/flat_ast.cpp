@@ -0,0 +1,106 @@
+#include <random>
+
+#include "../src/analysis/analsyis.h"
+#include "../src/compiler/compiler.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace ast;
+
+// Random arithmetic over a few globals and a small set of constants. Only operators the compiler supports are used so
+// both backends can run over the whole corpus.
+string random_expr(std::mt19937 &rng, size_t depth) {
+  if (depth == 0 || rng() % 4 == 0) {
+    const char *leaves[] = {"a", "b", "c", "1", "2", "3.5", "7"};
+    return leaves[rng() % 7];
+  }
+
+  const char *ops[] = {" + ", " - ", " * ", " / "};
+  string expr = random_expr(rng, depth - 1) + ops[rng() % 4] + random_expr(rng, depth - 1);
+  return rng() % 3 == 0 ? "(" + expr + ")" : expr;
+}
+
+string corpus(size_t statements) {
+  std::mt19937 rng(11);
+  string src;
+
+  for (size_t i = 0; i < statements; i++) {
+    src += "let v_" + to_string(i) + " = " + random_expr(rng, 5) + ";\n";
+  }
+
+  return src;
+}
+
+int main(int argc, const char **argv) {
+  size_t statements = 50000;
+
+  if (argc > 1) {
+    statements = (size_t)std::stoull(argv[1]);
+  }
+
+  auto [tokens, errs] = lexer::tokenize(bench::write_temp_source("flat_ast.br", corpus(statements)));
+  auto program = parser::parse(tokens);
+
+  vector<Expr *> roots;
+  for (Stmt *stmt : program->entry->body) {
+    roots.push_back(static_cast<VarDeclStmt *>(stmt)->value);
+  }
+
+  auto env = make_shared<analysis::Scope>();
+  env->is_global = true;
+  for (const char *name : {"a", "b", "c"}) {
+    env->defineSymbol(utils::intern(name), analysis::MK_NUM());
+  }
+
+  FlatExprs flat;
+  vector<NodeIndex> flat_roots;
+  double flatten = bench::best_of(1, [&]() {
+    for (Expr *root : roots) {
+      flat_roots.push_back(flat.append(root));
+    }
+  });
+
+  // Typechecking
+  vector<shared_ptr<analysis::Type>> tree_types, flat_types;
+  double tc_tree = bench::best_of(3, [&]() {
+    tree_types.clear();
+    for (Expr *root : roots) {
+      tree_types.push_back(analysis::tc_expr(root, env));
+    }
+  });
+  double tc_flat = bench::best_of(3, [&]() { flat_types = analysis::tc_flat_exprs(flat, env); });
+
+  // Compiling
+  compiler::Compiler tree_compiler, flat_compiler;
+  double compile_tree = bench::best_of(3, [&]() {
+    tree_compiler = compiler::Compiler{};
+    for (Expr *root : roots) {
+      tree_compiler.compile_expr(root, env);
+    }
+  });
+  double compile_flat = bench::best_of(3, [&]() {
+    flat_compiler = compiler::Compiler{};
+    flat_compiler.compile_flat_exprs(flat, flat_types, env);
+  });
+
+  // Both layouts must agree on every root type and on the emitted program.
+  for (size_t i = 0; i < roots.size(); i++) {
+    if (tree_types[i]->kind != flat_types[flat_roots[i]]->kind) {
+      std::cout << "flat typechecking differs from the tree at expression " << i << "\n";
+      return 1;
+    }
+  }
+
+  if (tree_compiler.code != flat_compiler.code ||
+      tree_compiler.data.size() != flat_compiler.data.size()) {
+    std::cout << "flat compilation differs from the tree\n";
+    return 1;
+  }
+
+  printf("%zu expressions, %zu nodes, flattened in %.1f ms\n", roots.size(), flat.size(), flatten * 1000);
+  printf("%-10s %12s %12s %10s\n", "pass", "tree (ms)", "flat (ms)", "speedup");
+  printf("%-10s %12.1f %12.1f %9.2fx\n", "typecheck", tc_tree * 1000, tc_flat * 1000, tc_tree / tc_flat);
+  printf("%-10s %12.1f %12.1f %9.2fx\n", "compile", compile_tree * 1000, compile_flat * 1000,
+         compile_tree / compile_flat);
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../src/analysis/analsyis.h"
+#include "../src/ast/dump.h"
+#include "../src/compiler/compiler.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+// Times every stage of the front end on a generated project and prints the results as one JSON object, so runs on
+// different commits can be compared by tools. Run through `make bench-frontend`, which passes ARGS along:
+//   frontend [modules] [functions per module] [structs per module] [expression depth]
+
+using namespace ast;
+
+// Counts the nodes of a tree by walking its dump without writing anything.
+class NodeCounter : public Dumper {
+public:
+  size_t nodes = 0;
+
+  void open(NodeKind) {
+    nodes++;
+  }
+  void open(const char *) {
+  }
+  void close() {
+  }
+  void open_list() {
+  }
+  void close_list() {
+  }
+  void key(const char *) {
+  }
+  void write_text(string_view) {
+  }
+  void write_flag(bool) {
+  }
+  void write_none() {
+  }
+};
+
+static size_t peak_rss_kb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (size_t)usage.ru_maxrss;
+}
+
+int main(int argc, const char **argv) {
+  bench::ProjectShape shape;
+  size_t *fields[] = {&shape.modules, &shape.functions, &shape.structs, &shape.depth};
+
+  for (int i = 1; i < argc && i <= 4; i++) {
+    *fields[i - 1] = (size_t)std::stoull(argv[i]);
+  }
+
+  string entry = bench::write_synthetic_project("bench_frontend", shape);
+  auto dir = std::filesystem::path(entry).parent_path();
+
+  size_t source_bytes = 0;
+  for (size_t m = 0; m < shape.modules; m++) {
+    source_bytes += std::filesystem::file_size(dir / ("m" + to_string(m) + ".br"));
+  }
+
+  // Lexing on its own, every module into a token buffer.
+  size_t tokens = 0;
+  double lex = bench::best_of(3, [&]() {
+    tokens = 0;
+    for (size_t m = 0; m < shape.modules; m++) {
+      auto [buffer, errs] = lexer::tokenize((dir / ("m" + to_string(m) + ".br")).string());
+      if (errs.size() > 0) {
+        errs[0].display();
+        exit(1);
+      }
+
+      tokens += buffer.size();
+    }
+  });
+  size_t lex_rss = peak_rss_kb();
+
+  // Parsing includes lexing, since the parser pulls tokens from the lexer as it goes.
+  shared_ptr<ProgramStmt> program;
+  double parse = bench::best_of(3, [&]() {
+    program = nullptr;
+    program = parser::parse(entry);
+  });
+  size_t parse_rss = peak_rss_kb();
+
+  NodeCounter counter;
+  program->dump(counter);
+
+  double check = bench::best_of(1, [&]() { analysis::tc_program(program); });
+  size_t check_rss = peak_rss_kb();
+
+  // Compiler::compile prints a listing of the bytecode through both iostreams and printf, so stdout itself is
+  // pointed at /dev/null while it runs.
+  std::cout.flush();
+  fflush(stdout);
+  int saved_stdout = dup(STDOUT_FILENO);
+  int null = open("/dev/null", O_WRONLY);
+  dup2(null, STDOUT_FILENO);
+
+  double compile = bench::best_of(1, [&]() {
+    compiler::Compiler compiler;
+    compiler.compile(program, (dir / "program.brbc").string());
+    std::cout.flush();
+    fflush(stdout);
+  });
+
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+  close(null);
+  size_t compile_rss = peak_rss_kb();
+
+  printf("{\"modules\":%zu,\"functions\":%zu,\"structs\":%zu,\"depth\":%zu,", shape.modules, shape.functions,
+         shape.structs, shape.depth);
+  printf("\"source_bytes\":%zu,\"tokens\":%zu,\"nodes\":%zu,\"stages\":{", source_bytes, tokens, counter.nodes);
+  printf("\"lex\":{\"ms\":%.3f,\"tokens_per_s\":%.0f,\"peak_rss_kb\":%zu},", lex * 1000, tokens / lex, lex_rss);
+  printf("\"parse\":{\"ms\":%.3f,\"nodes_per_s\":%.0f,\"peak_rss_kb\":%zu},", parse * 1000, counter.nodes / parse,
+         parse_rss);
+  printf("\"check\":{\"ms\":%.3f,\"nodes_per_s\":%.0f,\"peak_rss_kb\":%zu},", check * 1000, counter.nodes / check,
+         check_rss);
+  printf("\"compile\":{\"ms\":%.3f,\"nodes_per_s\":%.0f,\"peak_rss_kb\":%zu}},", compile * 1000,
+         counter.nodes / compile, compile_rss);
+  printf("\"peak_rss_kb\":%zu}\n", compile_rss);
+  return 0;
+}
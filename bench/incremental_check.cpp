@@ -0,0 +1,103 @@
+#include "../src/analysis/analsyis.h"
+#include "../src/analysis/query.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+// Runs `bedrock check` on a generated project, parsing included: from scratch, again with nothing changed, and again
+// after the body of a single function of a leaf module was edited. Modules come from the AST cache once it was written,
+// so a body which is reused is never decoded, the bodies of settled modules are not even looked at, and modules whose
+// summary is current are not built at all.
+//   incremental_check [modules] [functions per module]
+
+struct Counts {
+  size_t checked = 0;
+  size_t reused = 0;
+  size_t settled = 0; // modules whose bodies were left alone, see tc_program, unbuilt ones included
+};
+
+static Counts count_bodies(const ast::ProgramStmt &program) {
+  Counts counts;
+  counts.settled = program.summaries.size();
+  for (const auto &module : program.modules) {
+    counts.settled += module->scope->defer_bodies;
+    counts.checked += module->scope->queries->checked;
+    counts.reused += module->scope->queries->reused;
+  }
+
+  return counts;
+}
+
+// Rewrites the body of compute_0 in the module at path so that it returns `value` instead.
+static void edit_body(const string &path, size_t value) {
+  auto src = utils::read_file_contents(path).value();
+  auto at = src.find("return y + ");
+  auto end = src.find(";", at);
+  src.replace(at, end - at, "return y + " + to_string(value));
+
+  std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  file << src;
+}
+
+static shared_ptr<ast::ProgramStmt> check(const string &entry) {
+  auto program = parser::parse(entry, true);
+  analysis::tc_program(program, true);
+  return program;
+}
+
+static void print_row(const char *name, double seconds, Counts counts) {
+  printf("%-8s %10.1f ms %8zu checked %8zu reused %4zu settled\n", name, seconds * 1000, counts.checked, counts.reused,
+         counts.settled);
+}
+
+int main(int argc, const char **argv) {
+  bench::ProjectShape shape;
+  shape.modules = 16;
+  shape.functions = 256;
+
+  if (argc > 1) {
+    shape.modules = (size_t)std::stoull(argv[1]);
+  }
+
+  if (argc > 2) {
+    shape.functions = (size_t)std::stoull(argv[2]);
+  }
+
+  auto builds = std::filesystem::temp_directory_path() / "incremental_check_builds";
+  std::filesystem::remove_all(builds);
+  AST_CACHE = true;
+  COMPILED_FILES_PATH = builds.string() + "/";
+
+  auto entry = bench::write_synthetic_project("incremental_check", shape);
+  auto leaf = (std::filesystem::path(entry).parent_path() / ("m" + to_string(shape.modules - 1) + ".br")).string();
+  shared_ptr<ast::ProgramStmt> program;
+
+  double cold = bench::best_of(3, [&]() {
+    std::filesystem::remove_all(builds);
+    program = check(entry);
+  });
+  Counts cold_counts = count_bodies(*program);
+
+  double warm = bench::best_of(3, [&]() { program = check(entry); });
+  Counts warm_counts = count_bodies(*program);
+
+  // Every run edits the body again, so none of them finds its records from the run before.
+  double edited = 0;
+  Counts edited_counts;
+  for (size_t run = 0; run < 3; run++) {
+    edit_body(leaf, 1000 + run);
+
+    double seconds = bench::best_of(1, [&]() { program = check(entry); });
+    if (run == 0 || seconds < edited) {
+      edited = seconds;
+    }
+
+    edited_counts = count_bodies(*program);
+  }
+
+  printf("%zu modules of %zu functions\n", shape.modules, shape.functions);
+  print_row("cold", cold, cold_counts);
+  print_row("warm", warm, warm_counts);
+  print_row("edited", edited, edited_counts);
+  printf("speedup %.2fx warm, %.2fx edited\n", cold / warm, cold / edited);
+  return 0;
+}
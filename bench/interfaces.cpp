@@ -0,0 +1,81 @@
+#include "../src/analysis/analsyis.h"
+#include "../src/analysis/interface.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace analysis;
+
+// A module exporting a struct, a constant and a function per unit, so every kind of summary entry is exercised.
+static string library_source(size_t units) {
+  string src;
+
+  for (size_t i = 0; i < units; i++) {
+    string n = to_string(i);
+
+    src += "struct Point_" + n + " {\n  pub x: Number;\n  y: Number;\n}\n\n";
+    src += "const limit_" + n + " = " + n + ";\n\n";
+    src += "fn area_" + n + " (p: Point_" + n + ", k: Number) -> Number {\n";
+    src += "  let s = k * 2 + limit_" + n + ";\n";
+    src += "  return s;\n";
+    src += "}\n\n";
+  }
+
+  // tc_program requires the entry module to define main.
+  return src + "fn main () {\n}\n";
+}
+
+int main(int argc, const char **argv) {
+  size_t units = 20000;
+
+  if (argc > 1) {
+    units = (size_t)std::stoull(argv[1]);
+  }
+
+  COMPILED_FILES_PATH = (std::filesystem::temp_directory_path() / "bedrock_bench_cache").string() + "/";
+  string path = bench::write_temp_source("interfaces.br", library_source(units));
+
+  // What an importer pays without summaries: parsing and checking the whole dependency.
+  shared_ptr<ast::ModuleStmt> mod;
+  double check = bench::best_of(3, [&]() {
+    auto program = parser::parse(path);
+    tc_program(program);
+    mod = program->entry;
+  });
+
+  shared_ptr<Interface> summary = summarize(*mod);
+  store_interface(*summary);
+  size_t summary_bytes = std::filesystem::file_size(interface_path(path));
+
+  // Opening the source to hash it and reading the stored summary. The module itself is never built.
+  shared_ptr<Interface> loaded;
+  double load = bench::best_of(3, [&]() {
+    loaded = nullptr;
+    loaded = load_interface(path);
+  });
+
+  if (!loaded || serialize_interface(*loaded) != serialize_interface(*summary)) {
+    std::cout << "stored summary differs from the summary of the checked module\n";
+    return 1;
+  }
+
+  // A function and a constant per unit plus main.
+  size_t exports = units * 2 + 1;
+  if (summary->symbols.size() != exports || summary->types.size() != units || summary->constants.size() != units) {
+    std::cout << "summary is missing exported declarations\n";
+    return 1;
+  }
+
+  // Any edit to the source must invalidate the summary.
+  bench::write_temp_source("interfaces.br", library_source(units) + "\n");
+  if (load_interface(path)) {
+    std::cout << "stale summary was loaded after the source changed\n";
+    return 1;
+  }
+
+  double read = std::max(load, 1e-6);
+  printf("%zu exports, %.1f KB summary\n", summary->symbols.size() + summary->types.size(), summary_bytes / 1024.0);
+  printf("%-8s %8.1f ms\n", "check", check * 1000);
+  printf("%-8s %8.1f ms\n", "read", read * 1000);
+  printf("reading the summary is %.1fx faster than parsing and checking the module\n", check / read);
+  return 0;
+}
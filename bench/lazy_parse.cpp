@@ -0,0 +1,74 @@
+#include "../src/analysis/analsyis.h"
+#include "../src/ast/dump.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace ast;
+
+shared_ptr<ModuleStmt> parse_once(lexer::TokenBuffer &tokens, bool lazy) {
+  LAZY_FN_BODIES = lazy;
+  auto program = parser::parse(tokens);
+  LAZY_FN_BODIES = false;
+  return program->entry;
+}
+
+// Parses and checks a whole project the way `bedrock run` does. Nothing calls into the imported modules, so a lazy
+// run never builds their bodies.
+void run_once(const string &entry, bool lazy) {
+  LAZY_FN_BODIES = lazy;
+  analysis::tc_program(parser::parse(entry));
+  LAZY_FN_BODIES = false;
+}
+
+int main(int argc, const char **argv) {
+  size_t size = 8 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  string src = bench::synthetic_source(size);
+  auto [tokens, errs] = lexer::tokenize(bench::write_temp_source("lazy_parse.br", src));
+  if (errs.size() > 0) {
+    return 1;
+  }
+
+  shared_ptr<ModuleStmt> eager, lazy;
+  double eager_s = bench::best_of(3, [&]() { eager = parse_once(tokens, false); });
+  double lazy_s = bench::best_of(3, [&]() { lazy = parse_once(tokens, true); });
+  size_t lazy_bytes = lazy->arena.bytes_used();
+
+  // Building every skipped body must give back exactly the tree the eager parse produced.
+  double materialize_s = bench::best_of(1, [&]() {
+    for (Stmt *stmt : lazy->body) {
+      if (stmt->kind == FN_DECL_STMT) {
+        parser::fn_body(static_cast<FnDeclStmt *>(stmt));
+      }
+    }
+  });
+
+  if (debug_str(eager.get()) != debug_str(lazy.get())) {
+    std::cout << "lazily built bodies differ from the eager parse\n";
+    return 1;
+  }
+
+  printf("%-12s %10s %12s %10s\n", "mode", "parse", "arena", "MB/s");
+  printf("%-12s %7.1f ms %9.2f MB %10.1f\n", "eager", eager_s * 1000, eager->arena.bytes_used() / 1048576.0,
+         bench::mb_per_s(src.size(), eager_s));
+  printf("%-12s %7.1f ms %9.2f MB %10.1f\n", "lazy", lazy_s * 1000, lazy_bytes / 1048576.0,
+         bench::mb_per_s(src.size(), lazy_s));
+  printf("%-12s %7.1f ms\n", "all bodies", materialize_s * 1000);
+  printf("speedup %.2fx, arena %.2fx smaller\n", eager_s / lazy_s, (double)eager->arena.bytes_used() / lazy_bytes);
+
+  bench::ProjectShape shape;
+  shape.functions = 256;
+  string entry = bench::write_synthetic_project("lazy_parse_project", shape);
+  double eager_run = bench::best_of(3, [&]() { run_once(entry, false); });
+  double lazy_run = bench::best_of(3, [&]() { run_once(entry, true); });
+
+  printf("\n%zu modules of %zu functions, parsed and checked\n", shape.modules, shape.functions);
+  printf("%-12s %7.1f ms\n", "eager", eager_run * 1000);
+  printf("%-12s %7.1f ms\n", "lazy", lazy_run * 1000);
+  printf("speedup %.2fx\n", eager_run / lazy_run);
+  return 0;
+}
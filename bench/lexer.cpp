@@ -0,0 +1,178 @@
+#include <regex>
+
+#include "../src/lexing/lexer.h"
+#include "bench.h"
+
+using namespace lexer;
+
+// The regex driven scanner which lexer::tokenize replaced. Kept here as the baseline for throughput and as the
+// reference the token stream is checked against.
+namespace reference {
+struct Lexeme {
+  TokenKind kind;
+  string value;
+  size_t start;
+};
+
+vector<Lexeme> tokenize(const string &contents) {
+  using std::regex;
+  const int SKIP = -1, COMMENT = -2;
+
+  const vector<pair<regex, int>> patterns = {
+      {regex(R"(\s+)"), SKIP},
+      {regex(R"(\/\/.*)"), COMMENT},
+      {regex(R"("[^"]*")"), STRING},
+      {regex(R"([0-9]+(\.[0-9]+)?)"), NUMBER},
+      {regex(R"([a-zA-Z_@][a-zA-Z0-9_]*)"), IDENTIFIER},
+      {regex(R"(\[)"), OPEN_BRACKET},
+      {regex(R"(\])"), CLOSE_BRACKET},
+      {regex(R"(\{)"), OPEN_CURLY},
+      {regex(R"(\})"), CLOSE_CURLY},
+      {regex(R"(\()"), OPEN_PAREN},
+      {regex(R"(\))"), CLOSE_PAREN},
+      {regex(R"(\=\=)"), EQUALS},
+      {regex(R"(\!\=)"), NOT_EQUALS},
+      {regex(R"(!)"), NOT},
+      {regex(R"(=)"), ASSIGNMENT},
+      {regex(R"(->)"), ARROW},
+      {regex(R"(<)"), OPEN_GENERIC},
+      {regex(R"(>)"), CLOSE_GENERIC},
+      {regex(R"(\.\.)"), DOT_DOT},
+      {regex(R"(\.)"), DOT},
+      {regex(R"(;)"), SEMICOLON},
+      {regex(R"(::)"), COLON_COLON},
+      {regex(R"(:)"), COLON},
+      {regex(R"(\?)"), QUESTION},
+      {regex(R"(,)"), COMMA},
+      {regex(R"(\+\+)"), PLUS_PLUS},
+      {regex(R"(--)"), MINUS_MINUS},
+      {regex(R"(\+=)"), PLUS_EQUALS},
+      {regex(R"(-=)"), MINUS_EQUALS},
+      {regex(R"(/=)"), SLASH_EQUALS},
+      {regex(R"(\*=)"), STAR_EQUALS},
+      {regex(R"(\+)"), PLUS},
+      {regex(R"(-)"), MINUS},
+      {regex(R"(/)"), SLASH},
+      {regex(R"(\*)"), STAR},
+      {regex(R"(%)"), PERCENT},
+      {regex(R"(&)"), AMPERSAND},
+  };
+
+  vector<Lexeme> lexemes;
+  size_t pos = 0;
+
+  while (pos < contents.length()) {
+    bool matched = false;
+
+    for (const auto &[re, kind] : patterns) {
+      std::smatch match;
+      string remainder = contents.substr(pos);
+
+      if (!std::regex_search(remainder, match, re) || match.position() != 0) {
+        continue;
+      }
+
+      string text = match.str();
+      if (kind == STRING) {
+        lexemes.push_back({STRING, text.substr(1, text.length() - 2), pos});
+      } else if (kind == IDENTIFIER) {
+        lexemes.push_back({reserved_kind(text), text, pos});
+      } else if (kind >= 0) {
+        lexemes.push_back({(TokenKind)kind, text, pos});
+      }
+
+      pos += text.length();
+      matched = true;
+      break;
+    }
+
+    if (!matched) {
+      break;
+    }
+  }
+
+  return lexemes;
+}
+}; // namespace reference
+
+bool streams_match(const vector<reference::Lexeme> &expected, const TokenBuffer &recieved) {
+  // recieved always ends in an END_FILE token
+  if (expected.size() + 1 != recieved.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < expected.size(); i++) {
+    const auto tk = recieved.at(i);
+    if (expected[i].kind != tk.kind || expected[i].value != tk.value || expected[i].start != tk.offset) {
+      std::cout << "token " << i << " differs: " << token_tag(expected[i].kind) << " " << expected[i].value;
+      std::cout << " vs " << token_tag(tk.kind) << " " << tk.value << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Drains a TokenStream and checks it yields exactly the tokens of the buffer.
+bool stream_matches(TokenStream &stream, const TokenBuffer &expected) {
+  for (size_t i = 0; i < expected.size(); i++) {
+    auto tk = stream.advance();
+
+    if (tk.kind != expected.kind(i) || tk.offset != expected.offsets[i] || tk.length != expected.lengths[i]) {
+      std::cout << "streamed token " << i << " differs: " << token_tag(tk.kind) << " at " << tk.offset << "\n";
+      return false;
+    }
+  }
+
+  return stream.peek().kind == END_FILE;
+}
+
+int main(int argc, const char **argv) {
+  // Largest input handed to the regex reference. It is quadratic so anything bigger takes minutes.
+  const size_t REFERENCE_LIMIT = 32 * 1024;
+  vector<size_t> sizes = {4 * 1024, 16 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+
+  if (argc > 1) {
+    sizes = {(size_t)std::stoull(argv[1])};
+  }
+
+  printf("%-12s %-10s %14s %14s %14s\n", "bytes", "tokens", "regex MB/s", "scanner MB/s", "stream MB/s");
+
+  for (const auto size : sizes) {
+    string src = bench::synthetic_source(size);
+    string path = bench::write_temp_source("bedrock_lexer_bench.br", src);
+
+    TokenBuffer tokens;
+    double scanner = bench::best_of(3, [&]() { tokens = tokenize(path).first; });
+
+    // Pulls every token through the ring buffer the parser reads from.
+    double stream = bench::best_of(3, [&]() {
+      TokenStream s{path};
+      while (s.advance().kind != END_FILE) {
+      }
+    });
+
+    TokenStream check{path};
+    if (!stream_matches(check, tokens)) {
+      return 1;
+    }
+
+    string regex_rate = "-";
+    if (src.size() <= REFERENCE_LIMIT) {
+      vector<reference::Lexeme> expected;
+      double regex = bench::best_of(1, [&]() { expected = reference::tokenize(src); });
+
+      if (!streams_match(expected, tokens)) {
+        std::cout << "token stream does not match the regex reference for " << src.size() << " bytes\n";
+        return 1;
+      }
+
+      regex_rate = to_string(bench::mb_per_s(src.size(), regex));
+    }
+
+    printf("%-12zu %-10zu %14s %14.2f %14.2f\n", src.size(), tokens.size(), regex_rate.c_str(),
+           bench::mb_per_s(src.size(), scanner), bench::mb_per_s(src.size(), stream));
+  }
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/analysis/analsyis.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+// Type checks a generated project whose imports form a binary tree, so every level of the tree is a row of sibling
+// modules that tc_program checks in parallel.
+//   parallel_check [modules] [functions per module]
+
+// Two sibling modules, one of which has a syntax error inside a body skipped by the lazy parse. The body is only built
+// once its module is checked on the pool, and the error has to be reported like a type error. Reporting it ends the
+// process, so the check runs in a child. It forks before this process starts the pool, whose threads a child would
+// not have.
+static bool reports_lazy_body_errors() {
+  auto dir = std::filesystem::temp_directory_path() / "parallel_check_errors";
+  std::filesystem::create_directories(dir);
+  std::ofstream(dir / "a.br", std::ios::trunc) << "fn fa () {\n  let = ;\n}\n";
+  std::ofstream(dir / "b.br", std::ios::trunc) << "fn fb () {\n  let x = 1;\n}\n";
+  std::ofstream(dir / "main.br", std::ios::trunc) << "import(\"a\") as a;\nimport(\"b\") as b;\nfn main () {\n}\n";
+
+  int out[2];
+  if (pipe(out) != 0) {
+    return false;
+  }
+
+  pid_t child = fork();
+  if (child == 0) {
+    dup2(out[1], STDOUT_FILENO);
+    close(out[0]);
+    LAZY_FN_BODIES = true;
+    analysis::tc_program(parser::parse((dir / "main.br").string()), true);
+    _exit(0);
+  }
+
+  close(out[1]);
+  string printed;
+  char buffer[4096];
+  for (ssize_t n; (n = read(out[0], buffer, sizeof(buffer))) > 0;) {
+    printed.append(buffer, n);
+  }
+
+  close(out[0]);
+  int status = 0;
+  waitpid(child, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 1 && printed.find("Expected to find") != string::npos;
+}
+
+int main(int argc, const char **argv) {
+  if (!reports_lazy_body_errors()) {
+    std::cout << "a syntax error in a lazily built body was not reported from the pool\n";
+    return 1;
+  }
+
+  bench::ProjectShape shape;
+  shape.modules = 64;
+  shape.functions = 256;
+
+  if (argc > 1) {
+    shape.modules = (size_t)std::stoull(argv[1]);
+  }
+
+  if (argc > 2) {
+    shape.functions = (size_t)std::stoull(argv[2]);
+  }
+
+  // Only the scheduling is measured, so tc_program neither reads nor writes the summaries and records of the cache.
+  AST_CACHE = false;
+  auto program = parser::parse(bench::write_synthetic_project("parallel_check", shape));
+  double scheduled = bench::best_of(3, [&]() { analysis::tc_program(program); });
+
+  // Every module checked one after another on the calling thread, which is what tc_program did before. The summaries
+  // of the imports are the ones the runs above ended with.
+  auto session = program->entry->scope->session;
+  double sequential = bench::best_of(3, [&]() {
+    for (const auto &module : program->modules) {
+      analysis::tc_module(module, session);
+    }
+  });
+
+  printf("%zu modules of %zu functions on %zu workers\n", shape.modules, shape.functions, utils::thread_pool().size());
+  printf("%-12s %8.1f ms\n", "sequential", sequential * 1000);
+  printf("%-12s %8.1f ms\n", "scheduled", scheduled * 1000);
+  printf("speedup %.2fx\n", sequential / scheduled);
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "../src/lexing/lexer.h"
+#include "bench.h"
+
+using namespace lexer;
+
+// Source where chunk boundaries regularly land inside multi-line strings and inside comments holding quotes, so the
+// resync path of tokenize_chunked is exercised as well as the happy path.
+string hostile_source(size_t target_bytes) {
+  string src;
+
+  for (size_t i = 0; src.size() < target_bytes; i++) {
+    string n = to_string(i);
+
+    src += "const text_" + n + " = \"line one\nline \" two\n// not a comment\nfn not_code() {\n}\";\n";
+    src += "// a comment with a \" quote " + n + "\n";
+    src += "let x_" + n + " = " + n + " * (x_" + n + " - 1);\n";
+  }
+
+  return src;
+}
+
+bool identical(const pair<TokenBuffer, vector<Err>> &a, const pair<TokenBuffer, vector<Err>> &b) {
+  return a.first.kinds == b.first.kinds && a.first.offsets == b.first.offsets &&
+         a.first.lengths == b.first.lengths && a.first.symbols == b.first.symbols &&
+         a.second.size() == b.second.size();
+}
+
+pair<TokenBuffer, vector<Err>> tokenize_sequential(shared_ptr<SourceFile> file) {
+  Lexer lex{file};
+  lex.scan_until(SIZE_MAX);
+  lex.push(END_FILE, lex.pos, lex.pos);
+  return make_pair(std::move(lex.tokens), lex.errs);
+}
+
+int main(int argc, const char **argv) {
+  size_t size = 64 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  // Check the stitched output against sequential lexing for many chunk counts, including an unterminated string.
+  for (const string &src : {hostile_source(256 * 1024), hostile_source(256 * 1024) + "let broken = \"abc\n"}) {
+    auto file = SourceFile::from_string("hostile.br", src);
+    auto expected = tokenize_sequential(file);
+    utils::ThreadPool pool(4);
+
+    for (size_t chunks = 1; chunks <= 257; chunks += 8) {
+      if (!identical(expected, tokenize_chunked(file, pool, chunks))) {
+        std::cout << "chunked lexing with " << chunks << " chunks differs from sequential lexing\n";
+        return 1;
+      }
+    }
+  }
+
+  auto file = SourceFile::from_string("bench.br", bench::synthetic_source(size));
+  pair<TokenBuffer, vector<Err>> expected;
+  double sequential = bench::best_of(3, [&]() { expected = tokenize_sequential(file); });
+
+  printf("%-10s %-10s %12s %10s\n", "threads", "chunks", "MB/s", "speedup");
+  printf("%-10s %-10s %12.2f %10s\n", "1", "-", bench::mb_per_s(file->contents.size(), sequential), "1.00x");
+
+  // Always go up to 4 threads so the stitching overhead shows up even on small machines.
+  size_t hardware = std::max(4u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; threads <= hardware; threads *= 2) {
+    utils::ThreadPool pool(threads);
+    pair<TokenBuffer, vector<Err>> recieved;
+    double seconds = bench::best_of(3, [&]() { recieved = tokenize_chunked(file, pool, threads * 4); });
+
+    if (!identical(expected, recieved)) {
+      std::cout << "chunked lexing on " << threads << " threads differs from sequential lexing\n";
+      return 1;
+    }
+
+    printf("%-10zu %-10zu %12.2f %9.2fx\n", threads, threads * 4, bench::mb_per_s(file->contents.size(), seconds),
+           sequential / seconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+// A project of `count` modules where module i imports modules 2i + 1 and 2i + 2, so the import graph is a binary
+// tree. Every module carries roughly `bytes` of generated functions.
+string write_project(size_t count, size_t bytes) {
+  auto dir = std::filesystem::temp_directory_path() / "parallel_modules";
+  std::filesystem::create_directories(dir);
+  string body = bench::synthetic_source(bytes);
+
+  for (size_t i = 0; i < count; i++) {
+    string src;
+    for (size_t child : {2 * i + 1, 2 * i + 2}) {
+      if (child < count) {
+        src += "import(\"m" + to_string(child) + "\") as m" + to_string(child) + ";\n";
+      }
+    }
+
+    std::ofstream file(dir / ("m" + to_string(i) + ".br"), std::ios::out | std::ios::trunc | std::ios::binary);
+    file << src << body;
+  }
+
+  return (dir / "m0.br").string();
+}
+
+int main(int argc, const char **argv) {
+  size_t count = 48;
+  size_t bytes = 256 * 1024;
+
+  if (argc > 1) {
+    count = (size_t)std::stoull(argv[1]);
+  }
+
+  string entry = write_project(count, bytes);
+
+  // Every module parsed one after another without following imports, which is what a sequential driver pays.
+  double sequential = bench::best_of(3, [&]() {
+    for (size_t i = 0; i < count; i++) {
+      auto path = std::filesystem::path(entry).parent_path() / ("m" + to_string(i) + ".br");
+      lexer::TokenStream tokens{path.string()};
+      parser::Parser p{tokens};
+      p.manager = make_shared<parser::ParserManager>();
+      parser::parse_module(p);
+    }
+  });
+
+  vector<string> order;
+  double scheduled = bench::best_of(3, [&]() {
+    lexer::TokenStream tokens{entry};
+    auto program = parser::parse(tokens);
+    vector<string> names;
+    for (auto &mod : program->modules) {
+      names.push_back(mod->name);
+    }
+
+    // The order must not depend on which worker finished first.
+    if (order.size() > 0 && names != order) {
+      std::cout << "module order changed between runs\n";
+      exit(1);
+    }
+
+    order = names;
+  });
+
+  if (order.size() != count || order.back() != entry) {
+    std::cout << "expected " << count << " modules ending with the entry, found " << order.size() << "\n";
+    return 1;
+  }
+
+  printf("%zu modules of %zu KB on %zu workers\n", count, bytes / 1024, utils::thread_pool().size());
+  printf("%-12s %8.1f ms\n", "sequential", sequential * 1000);
+  printf("%-12s %8.1f ms\n", "scheduled", scheduled * 1000);
+  printf("speedup %.2fx\n", sequential / scheduled);
+  return 0;
+}
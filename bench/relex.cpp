@@ -0,0 +1,78 @@
+#include <random>
+
+#include "../src/lexing/lexer.h"
+#include "bench.h"
+
+using namespace lexer;
+
+bool identical(const pair<TokenBuffer, vector<Err>> &a, const pair<TokenBuffer, vector<Err>> &b) {
+  return a.first.kinds == b.first.kinds && a.first.offsets == b.first.offsets &&
+         a.first.lengths == b.first.lengths && a.first.symbols == b.first.symbols &&
+         a.second.size() == b.second.size();
+}
+
+pair<TokenBuffer, vector<Err>> tokenize_sequential(shared_ptr<SourceFile> file) {
+  Lexer lex{file};
+  lex.scan_until(SIZE_MAX);
+  lex.push(END_FILE, lex.pos, lex.pos);
+  return make_pair(std::move(lex.tokens), lex.errs);
+}
+
+// Edits which change how the rest of the file lexes are the interesting ones. Quotes, slashes and digits open or
+// close strings, comments and numbers, and deleting across tokens merges them.
+Edit random_edit(std::mt19937 &rng, size_t length) {
+  const vector<string> insertions = {"\"", "/", "//", "\n", " ", "x", "1", ".", "5.", "fn", "\"a\"", "#", "-"};
+  size_t offset = rng() % (length + 1);
+  size_t removed = std::min<size_t>(rng() % 4, length - offset);
+  string inserted = rng() % 4 == 0 ? "" : insertions[rng() % insertions.size()];
+
+  return Edit{offset, removed, inserted};
+}
+
+int main(int argc, const char **argv) {
+  size_t size = 16 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  // Apply a chain of random edits to a small file, checking every result against lexing the edited file from scratch.
+  std::mt19937 rng(7);
+  auto file = SourceFile::from_string("relex.br", bench::synthetic_source(16 * 1024));
+  auto tokens = tokenize_sequential(file);
+
+  for (size_t i = 0; i < 2000; i++) {
+    Edit edit = random_edit(rng, file->contents.length());
+    auto edited = apply_edit(*file, edit);
+    auto expected = tokenize_sequential(edited);
+    auto result = relex(std::move(tokens.first), edited, edit);
+
+    if (!identical(expected, result)) {
+      std::cout << "re-lexing differs from lexing from scratch after edit " << i << " at offset " << edit.offset
+                << "\n";
+      return 1;
+    }
+
+    file = edited;
+    tokens = std::move(result);
+  }
+
+  // A single character edit in the middle of a large file, which resynchronises within a line.
+  file = SourceFile::from_string("bench.br", bench::synthetic_source(size));
+  Edit edit{file->contents.length() / 2, 1, "y"};
+  auto edited = apply_edit(*file, edit);
+  auto previous = tokenize_sequential(file).first;
+
+  pair<TokenBuffer, vector<Err>> full, incremental;
+  double full_time = bench::best_of(3, [&]() { full = tokenize_sequential(edited); });
+  double relex_time = bench::best_of(3, [&]() { incremental = relex(previous, edited, edit); });
+
+  if (!identical(full, incremental)) {
+    return 1;
+  }
+
+  printf("%-12s %12s %12s\n", "", "time (ms)", "speedup");
+  printf("%-12s %12.3f %12.2f\n", "full", full_time * 1000, 1.0);
+  printf("%-12s %12.3f %12.2f\n", "relex", relex_time * 1000, full_time / relex_time);
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <random>
+
+#include "../src/lexing/scan.h"
+#include "bench.h"
+
+using namespace lexer::scan;
+
+// Every SIMD kernel must return exactly what the scalar kernel returns. Inputs are built so runs end at every offset
+// within and across vector boundaries, including runs which reach the end of the buffer.
+bool kernels_match(const Kernels &k, const Kernels &scalar) {
+  const string alphabet = " \t\n\r\v\fabcXYZ019_\"/@;{}\x80\xff";
+  std::mt19937 rng(42);
+
+  for (size_t length = 0; length < 200; length++) {
+    for (size_t trial = 0; trial < 50; trial++) {
+      // Long runs of a single class followed by a random tail so the first stop lands at varying offsets.
+      string buf;
+      char fill = " a\"x"[trial % 4];
+      size_t run = rng() % (length + 1);
+      buf.append(run, fill);
+
+      while (buf.size() < length) {
+        buf += alphabet[rng() % alphabet.size()];
+      }
+
+      const char *b = buf.data(), *e = buf.data() + buf.size();
+      for (size_t start = 0; start <= buf.size(); start += 1 + rng() % 7) {
+        const char *p = b + start;
+        vector<uint32_t> expected(scalar.count_newlines(p, e)), recieved(expected.size());
+        scalar.line_starts(p, e, expected.data());
+
+        if (k.skip_whitespace(p, e) != scalar.skip_whitespace(p, e) ||
+            k.skip_identifier(p, e) != scalar.skip_identifier(p, e) ||
+            k.find_line_end(p, e) != scalar.find_line_end(p, e) || k.find_quote(p, e) != scalar.find_quote(p, e) ||
+            k.count_newlines(p, e) != expected.size() || k.line_starts(p, e, recieved.data()) != expected.size() ||
+            recieved != expected) {
+          std::cout << k.name << " differs from scalar on a " << length << " byte input at offset " << start << "\n";
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv) {
+  size_t size = 16 * 1024 * 1024;
+
+  if (argc > 1) {
+    size = (size_t)std::stoull(argv[1]);
+  }
+
+  vector<const Kernels *> kernels = {&scalar_kernels()};
+  for (const Kernels *k : {sse2_kernels(), avx2_kernels()}) {
+    if (k) {
+      kernels.push_back(k);
+    }
+  }
+
+  for (const Kernels *k : kernels) {
+    if (!kernels_match(*k, scalar_kernels())) {
+      return 1;
+    }
+  }
+
+  // Each input is a single run for its kernel so the numbers show peak throughput.
+  string whitespace(size, ' ');
+  string identifier(size, 'a');
+  string comment(size, 'c');
+  string text(size, 'x');
+  string lines(size, 'x');
+  for (size_t i = 0; i < size; i += 40) {
+    lines[i] = '\n';
+  }
+
+  std::cout << "active kernels: " << ACTIVE_KERNELS->name << "\n";
+  printf("%-8s %14s %14s %14s %14s %14s %14s\n", "kernels", "whitespace", "identifier", "comment", "string",
+         "newlines", "line starts");
+
+  for (const Kernels *k : kernels) {
+    const char *end;
+    size_t count, starts;
+    vector<uint32_t> offsets(size / 40 + 1);
+
+    auto rate = [&](const string &buf, auto fn) {
+      double seconds = bench::best_of(5, [&]() { fn(buf.data(), buf.data() + buf.size()); });
+      return bench::mb_per_s(buf.size(), seconds) / 1024.0;
+    };
+
+    double ws = rate(whitespace, [&](const char *b, const char *e) { end = k->skip_whitespace(b, e); });
+    double id = rate(identifier, [&](const char *b, const char *e) { end = k->skip_identifier(b, e); });
+    double cm = rate(comment, [&](const char *b, const char *e) { end = k->find_line_end(b, e); });
+    double st = rate(text, [&](const char *b, const char *e) { end = k->find_quote(b, e); });
+    double nl = rate(lines, [&](const char *b, const char *e) { count = k->count_newlines(b, e); });
+    double ls = rate(lines, [&](const char *b, const char *e) { starts = k->line_starts(b, e, offsets.data()); });
+
+    if (end == nullptr || count != (size + 39) / 40 || starts != count) {
+      return 1;
+    }
+
+    printf("%-8s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s\n", k->name, ws, id, cm, st, nl,
+           ls);
+  }
+
+  return 0;
+}
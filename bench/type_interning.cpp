@@ -0,0 +1,61 @@
+#include "../src/analysis/types.h"
+#include "bench.h"
+
+using namespace analysis;
+
+// Builds fn types of `arity` parameters whose parameter types cycle through Number, &Number, String and &&Bool.
+static shared_ptr<FnType> signature(size_t arity, size_t seed) {
+  shared_ptr<Type> kinds[] = {MK_NUM(), MK_PTR(MK_NUM()), MK_STR(), MK_PTR(MK_PTR(MK_BOOL()))};
+  vector<FnParam> params;
+
+  for (size_t i = 0; i < arity; i++) {
+    params.push_back(FnParam(utils::intern("p" + to_string(i)), kinds[(seed + i) % 4]));
+  }
+
+  return MK_FN(params, kinds[seed % 4], false);
+}
+
+int main(int argc, const char **argv) {
+  size_t checks = 2000000;
+
+  if (argc > 1) {
+    checks = (size_t)std::stoull(argv[1]);
+  }
+
+  // Pairs which are equal apart from where they were declared, and pairs which differ in a single parameter.
+  vector<pair<shared_ptr<Type>, shared_ptr<Type>>> pairs;
+  for (size_t i = 0; i < 64; i++) {
+    pairs.emplace_back(signature(4 + i % 4, i), signature(4 + i % 4, i));
+    pairs.emplace_back(signature(4, i), signature(4, i + 1));
+  }
+
+  size_t by_str = 0, by_id = 0;
+
+  // What types_match did before types were interned.
+  double str = bench::best_of(3, [&]() {
+    by_str = 0;
+    for (size_t i = 0; i < checks; i++) {
+      auto &[a, b] = pairs[i % pairs.size()];
+      by_str += a->kind == b->kind && a->str() == b->str();
+    }
+  });
+
+  double id = bench::best_of(3, [&]() {
+    by_id = 0;
+    for (size_t i = 0; i < checks; i++) {
+      auto &[a, b] = pairs[i % pairs.size()];
+      by_id += types_match(a, b);
+    }
+  });
+
+  if (by_str != by_id) {
+    std::cout << "comparing ids disagrees with comparing type strings\n";
+    return 1;
+  }
+
+  printf("%zu checks of fn signatures, %zu distinct types\n", checks, interned_type_count());
+  printf("%-8s %10.2f ms %10.1f ns/check\n", "str", str * 1000, str * 1e9 / checks);
+  printf("%-8s %10.2f ms %10.1f ns/check\n", "id", id * 1000, id * 1e9 / checks);
+  printf("speedup %.0fx\n", str / id);
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "../src/analysis/analsyis.h"
+#include "../src/compiler/compiler.h"
+#include "../src/parser/parser.h"
+#include "bench.h"
+
+using namespace ast;
+
+// A single sum of `terms` literals, which parses into a chain of + leaning to the left. The compiler cannot emit
+// string constants yet, so numbers stand in for a concatenation. Both went through the same check of the left operand.
+static string sum_chain(size_t terms) {
+  string src = "let s = 0";
+  for (size_t i = 1; i < terms; i++) {
+    src += " + " + to_string(i);
+  }
+
+  return src + ";\n";
+}
+
+// What compile_binary_expr did before types were kept on the nodes: checking the left operand of every + again.
+static void recheck(Expr *expr, shared_ptr<analysis::Scope> env) {
+  if (expr->kind != BINARY_EXPR) {
+    return;
+  }
+
+  auto binary = static_cast<BinaryExpr *>(expr);
+  recheck(binary->left, env);
+  recheck(binary->right, env);
+  if (binary->operation.kind == lexer::PLUS) {
+    analysis::tc_expr(binary->left, env);
+  }
+}
+
+int main(int argc, const char **argv) {
+  size_t longest = 4096;
+
+  if (argc > 1) {
+    longest = (size_t)std::stoull(argv[1]);
+  }
+
+  printf("%-8s %14s %14s %10s\n", "terms", "rechecked (ms)", "typed (ms)", "speedup");
+
+  for (size_t terms = 64; terms <= longest; terms *= 4) {
+    auto program = parser::parse(bench::write_temp_source("typed_ast.br", sum_chain(terms)));
+    Expr *chain = static_cast<VarDeclStmt *>(program->entry->body[0])->value;
+
+    auto env = make_shared<analysis::Scope>();
+    env->is_global = true;
+    analysis::tc_expr(chain, env);
+
+    double typed = bench::best_of(3, [&]() {
+      compiler::Compiler compiler;
+      compiler.compile_expr(chain, env);
+    });
+
+    double rechecked = bench::best_of(3, [&]() {
+      compiler::Compiler compiler;
+      compiler.compile_expr(chain, env);
+      recheck(chain, env);
+    });
+
+    printf("%-8zu %14.3f %14.3f %9.1fx\n", terms, rechecked * 1000, typed * 1000, rechecked / typed);
+  }
+
+  return 0;
+}
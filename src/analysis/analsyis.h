@@ -3,25 +3,53 @@
 #include "../ast/ast_macro.h"
 #include "../ast/ast_stmt.h"
 #include "../ast/ast_type.h"
+#include "../ast/flat.h"
 #include "../bedrock.h"
 #include "scope.h"
 #include "types.h"
 
 namespace analysis {
 
-shared_ptr<analysis::Type> tc_stmt(shared_ptr<ast::Stmt>, shared_ptr<analysis::Scope>);
-shared_ptr<analysis::Type> tc_expr(shared_ptr<ast::Expr>, shared_ptr<analysis::Scope>);
-shared_ptr<analysis::Type> tc_type(shared_ptr<ast::Type>, shared_ptr<analysis::Scope>);
+// Diagnostics
+/// @brief Thrown by fail while tc_program checks a module. The error itself was written to diag.
+struct CheckFailed {};
+
+/// @brief Stream errors found while checking are written to. While tc_program checks a module it buffers the module's
+/// errors until the module's level is done, otherwise it is std::cout.
+std::ostream &diag();
+/// @brief Stops checking after an error was written to diag. Throws CheckFailed while tc_program checks a module,
+/// otherwise exits.
+[[noreturn]] void fail();
+/// @brief Builds the body of fn, see parser::fn_body. A body which fails to build is reported like a type error.
+ast::BlockStmt *body_of(ast::FnDeclStmt *fn);
+
+shared_ptr<analysis::Type> tc_stmt(ast::Stmt *, shared_ptr<analysis::Scope>);
+shared_ptr<analysis::Type> tc_expr(ast::Expr *, shared_ptr<analysis::Scope>);
+shared_ptr<analysis::Type> tc_type(ast::Type *, shared_ptr<analysis::Scope>);
 
 // Statements
-shared_ptr<analysis::Type> tc_program(shared_ptr<ast::ProgramStmt>);
-shared_ptr<analysis::Type> tc_module(shared_ptr<ast::ModuleStmt>);
+/// @brief Checks every module of a program. With check_only nothing is compiled from the program afterwards, so
+/// imported modules which are unchanged since their summary was stored, as are the summaries they import, keep their
+/// bodies unchecked, and the bodies of fns which did not change since the last run, nor anything they read, are not
+/// checked again. Modules which parser::parse left unbuilt are only seen through ProgramStmt::summaries, so a program
+/// parsed with check_only has to be checked with it too.
+shared_ptr<analysis::Type> tc_program(shared_ptr<ast::ProgramStmt>, bool check_only = false);
+/// @brief Checks a module against the globals and summaries of session. The bodies of a settled module passed in an
+/// earlier run and are left to the calls which need them, see Scope::defer_bodies.
+shared_ptr<analysis::Type> tc_module(shared_ptr<ast::ModuleStmt>, shared_ptr<analysis::CheckSession>,
+                                     bool check_only = false, bool settled = false);
 shared_ptr<analysis::Type> tc_var_decl_stmt(ast::VarDeclStmt *, shared_ptr<analysis::Scope>);
 shared_ptr<analysis::Type> tc_fn_decl_stmt(ast::FnDeclStmt *, shared_ptr<analysis::Scope>);
+/// @brief Checks the body of a fn declared in env against a frame holding its parameters, parented on env. A body is
+/// checked and bound once, where it is declared, so what a name inside it refers to never depends on the caller.
+void tc_fn_body(ast::FnDeclStmt *, analysis::FnType &, shared_ptr<analysis::Scope> env);
+/// @brief Checks the body of callee on its first call when its module deferred it, see Scope::deferred.
+void tc_deferred_body(utils::SymbolId callee, shared_ptr<analysis::Scope> env);
 shared_ptr<analysis::Type> tc_struct_stmt(ast::StructStmt *, shared_ptr<analysis::Scope>);
 shared_ptr<analysis::Type> tc_block_stmt(ast::BlockStmt *);
 shared_ptr<analysis::Type> tc_expr_stmt(ast::ExprStmt *, shared_ptr<analysis::Scope>);
 shared_ptr<analysis::Type> tc_return_stmt(ast::ReturnStmt *, shared_ptr<analysis::Scope>);
+shared_ptr<analysis::Type> tc_import_stmt(ast::ImportStmt *, shared_ptr<analysis::Scope>);
 
 // Expressions
 shared_ptr<analysis::Type> tc_symbol_expr(ast::SymbolExpr *, shared_ptr<analysis::Scope>);
@@ -36,4 +64,19 @@ shared_ptr<analysis::Type> tc_fmt_macro(ast::FmtMacro *, shared_ptr<analysis::Sc
 shared_ptr<analysis::Type> tc_str_macro(ast::StrMacro *, shared_ptr<analysis::Scope>);
 shared_ptr<analysis::Type> tc_num_macro(ast::NumMacro *, shared_ptr<analysis::Scope>);
 
-}; // namespace analysis
\ No newline at end of file
+// Typing rules shared by the tree and flat walkers. Each takes the already checked types of a node's operands.
+shared_ptr<analysis::Type> tc_binary_op(shared_ptr<analysis::Type> l, shared_ptr<analysis::Type> r, lexer::TokenKind);
+shared_ptr<analysis::Type> tc_prefix_op(shared_ptr<analysis::Type> rhs, lexer::TokenKind);
+shared_ptr<analysis::Type> tc_assignment(ast::AssignTarget, utils::SymbolId, shared_ptr<analysis::Type> rhs,
+                                         shared_ptr<analysis::Scope>);
+shared_ptr<analysis::Type> tc_call(shared_ptr<analysis::Type> calle, const vector<shared_ptr<analysis::Type>> &args);
+shared_ptr<analysis::Type> tc_log(shared_ptr<analysis::Type> arg);
+shared_ptr<analysis::Type> tc_fmt(const string &fmt, const vector<shared_ptr<analysis::Type>> &args);
+shared_ptr<analysis::Type> tc_str(shared_ptr<analysis::Type> arg);
+shared_ptr<analysis::Type> tc_num(shared_ptr<analysis::Type> arg);
+
+// Flat AST
+/// @brief Typechecks every node of exprs in a single front to back pass and returns the type of each node by index.
+vector<shared_ptr<analysis::Type>> tc_flat_exprs(const ast::FlatExprs &, shared_ptr<analysis::Scope>);
+
+}; // namespace analysis
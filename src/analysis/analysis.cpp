@@ -1,27 +1,10 @@
 #include "../ast/ast_stmt.h"
 #include "analsyis.h"
+#include "query.h"
 
 using namespace analysis;
 using namespace ast;
 
-shared_ptr<Scope> Scope::global = make_shared<Scope>();
-unordered_map<string, shared_ptr<Scope>> Scope::modules;
-
-void analysis::Scope::debugAllScopes() {
-  if (!DISPLAY_TYPEINFO)
-    return;
-
-  for (const auto &[_, scope] : Scope::modules) {
-    if (scope->is_global) {
-      continue;
-    }
-
-    scope->debugScope();
-  }
-
-  Scope::global->debugScope();
-}
-
 void analysis::Scope::debugScope() {
   size_t PADDING = 10;
   if (!DISPLAY_TYPEINFO)
@@ -51,11 +34,12 @@ void analysis::Scope::debugScope() {
           continue;
         }
 
-        cout << "  " << white(name) << ":" << space((uint)(PADDING - name.size()));
+        auto text = utils::symbol_str(name);
+        cout << "  " << white(string(text)) << ":" << space((uint)(PADDING - text.size()));
         cout << type->str() << "\n";
       }
 
-      std::cout << "\n";
+      cout << "\n";
     }
   }
 
@@ -66,42 +50,54 @@ void analysis::Scope::debugScope() {
       }
     }
 
-    std::cout << "\n";
+    cout << "\n";
   }
 
   if (symbols.size() > 0) {
     cout << yellow("symbols") << ":\n";
     for (const auto &[name, type] : symbols) {
-      cout << "  " << white(name) << ":" << space((uint)(PADDING - name.size()));
+      auto text = utils::symbol_str(name);
+      cout << "  " << white(string(text)) << ":" << space((uint)(PADDING - text.size()));
       cout << type->str() << "\n";
     }
 
-    std::cout << "\n";
+    cout << "\n";
   }
 
   cout << "\n\n"; // end
 }
 
 // Scope Functions
-void analysis::Scope::defineSymbol(string name, shared_ptr<analysis::Type> type, bool constant) {
+uint32_t analysis::Scope::defineSymbol(utils::SymbolId name, shared_ptr<analysis::Type> type, bool constant) {
   symbols[name] = type;
   constants[name] = constant;
+
+  auto [it, inserted] = slots.try_emplace(name, next_slot);
+  if (inserted) {
+    next_slot++;
+  }
+
+  Scope *fn = frame();
+  if (!is_global && !is_module && fn) {
+    fn->frame_size = std::max(fn->frame_size, next_slot);
+  }
+
+  return it->second;
 }
 
-void analysis::Scope::defineSymbol(string name, shared_ptr<analysis::Type> type) {
-  symbols[name] = type;
-  constants[name] = false;
+uint32_t analysis::Scope::defineSymbol(utils::SymbolId name, shared_ptr<analysis::Type> type) {
+  return defineSymbol(name, type, false);
 }
 
-void analysis::Scope::defineType(string name, shared_ptr<analysis::Type> type) {
+void analysis::Scope::defineType(utils::SymbolId name, shared_ptr<analysis::Type> type) {
   types[name] = type;
 }
 
-bool analysis::Scope::symbolExists(string name) {
+bool analysis::Scope::symbolExists(utils::SymbolId name) {
   return symbols.find(name) != symbols.end();
 }
 
-bool analysis::Scope::typeExists(string name) {
+bool analysis::Scope::typeExists(utils::SymbolId name) {
   return types.find(name) != types.end();
 }
 
@@ -112,15 +108,20 @@ void analysis::Scope::registerFoundReturnType(shared_ptr<Type> returnType) {
   }
 
   if (parent == nullptr) {
-    std::cout << "Cannot preform return statement outside function body\n";
-    exit(1);
+    diag() << "Cannot preform return statement outside function body\n";
+    fail();
   }
 
   return parent->registerFoundReturnType(returnType);
 }
 
-shared_ptr<analysis::Type> analysis::Scope::resolveSymbol(string name) {
+// Lookups which end at the top level of a module are what a fn body depends on, see note_read.
+shared_ptr<analysis::Type> analysis::Scope::resolveSymbol(utils::SymbolId name) {
   if (symbolExists(name)) {
+    if (is_module) {
+      note_read(DECL_TYPE, name);
+    }
+
     return symbols[name];
   }
 
@@ -128,15 +129,20 @@ shared_ptr<analysis::Type> analysis::Scope::resolveSymbol(string name) {
     return parent->resolveSymbol(name);
   }
 
-  if (global->symbols.find(name) != global->symbols.end()) {
+  Scope *global = get_global();
+  if (global && global->symbols.find(name) != global->symbols.end()) {
     return global->symbols[name];
   }
 
   return nullptr;
 }
 
-shared_ptr<analysis::Type> analysis::Scope::resolveType(string name) {
+shared_ptr<analysis::Type> analysis::Scope::resolveType(utils::SymbolId name) {
   if (typeExists(name)) {
+    if (is_module) {
+      note_read(STRUCT_LAYOUT, name);
+    }
+
     return types[name];
   }
 
@@ -144,14 +150,15 @@ shared_ptr<analysis::Type> analysis::Scope::resolveType(string name) {
     return parent->resolveType(name);
   }
 
-  if (global->types.find(name) != global->types.end()) {
+  Scope *global = get_global();
+  if (global && global->types.find(name) != global->types.end()) {
     return global->types[name];
   }
 
   return nullptr;
 }
 
-Scope *analysis::Scope::resolveSymbolScope(string name) {
+Scope *analysis::Scope::resolveSymbolScope(utils::SymbolId name) {
   if (symbols.find(name) != symbols.end()) {
     return this;
   }
@@ -163,10 +170,55 @@ Scope *analysis::Scope::resolveSymbolScope(string name) {
   return nullptr;
 }
 
+Binding analysis::Scope::bind(utils::SymbolId name) {
+  Binding binding;
+
+  for (Scope *scope = this; scope; scope = scope->parent.get()) {
+    if (auto it = scope->slots.find(name); it != scope->slots.end()) {
+      binding.kind = scope->is_global ? Binding::GLOBAL : scope->is_module ? Binding::MODULE : Binding::LOCAL;
+      binding.slot = it->second;
+      if (binding.kind != Binding::LOCAL) {
+        binding.depth = 0;
+      }
+
+      return binding;
+    }
+
+    if (scope->is_function) {
+      binding.depth++;
+    }
+  }
+
+  binding.depth = 0;
+  if (Scope *global = get_global()) {
+    if (auto it = global->slots.find(name); it != global->slots.end()) {
+      binding.kind = Binding::GLOBAL;
+      binding.slot = it->second;
+    }
+  }
+
+  return binding;
+}
+
+Scope *analysis::Scope::frame() {
+  for (Scope *scope = this; scope; scope = scope->parent.get()) {
+    if (scope->is_function) {
+      return scope;
+    }
+  }
+
+  return nullptr;
+}
+
 Scope *analysis::Scope::get_module() {
-  if (parent == nullptr && is_module) {
+  if (is_module) {
     return this;
   }
 
-  return parent->get_module();
+  return parent ? parent->get_module() : nullptr;
+}
+
+Scope *analysis::Scope::get_global() {
+  Scope *module = get_module();
+  return module && module->session ? module->session->global.get() : nullptr;
 }
\ No newline at end of file
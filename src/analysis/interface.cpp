@@ -0,0 +1,411 @@
+#include "interface.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "../ast/cache.h"
+#include "../util/files.h"
+
+using namespace analysis;
+
+// Layout of a summary:
+//   magic[8] format:u32 hash:u64 module:str
+//   symbols: count:u32 (name:str type)*, types: count:u32 (name:str type)*, constants: count:u32 name:str*
+//   imports: count:u32 (module:str hash:u64)*
+// Names are written as text since interned ids differ between runs, and every table is sorted by name so an unchanged
+// interface always produces the same bytes. A struct is written with its declaring module, in full the first time it
+// is met and by index after that.
+
+namespace {
+constexpr char MAGIC[8] = {'B', 'R', 'I', 'F', 'A', 'C', 'E', 0};
+constexpr uint32_t FORMAT_VERSION = 4;
+constexpr uint8_t STRUCT_REF = 0xFF;
+
+template <typename Map> vector<pair<string, typename Map::mapped_type>> sorted_by_name(const Map &map) {
+  vector<pair<string, typename Map::mapped_type>> entries;
+  for (const auto &[name, value] : map) {
+    entries.emplace_back(utils::symbol_name(name), value);
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  return entries;
+}
+
+struct Writer {
+  string out;
+  bool failed = false;
+  unordered_map<Type *, uint32_t> structs;
+
+  template <typename T> void put(T value) {
+    out.append((const char *)&value, sizeof(T));
+  }
+
+  void str(string_view s) {
+    put<uint32_t>(s.length());
+    out += s;
+  }
+
+  template <typename Map> void table(const Map &map) {
+    auto entries = sorted_by_name(map);
+    put<uint32_t>(entries.size());
+    for (const auto &[name, type] : entries) {
+      str(name);
+      this->type(type.get());
+    }
+  }
+
+  void type(Type *type) {
+    put<uint8_t>(type->kind);
+
+    switch (type->kind) {
+    case NUMBER:
+    case STRING:
+    case BOOL:
+    case VOID:
+      return;
+    case POINTER:
+      return this->type(static_cast<PointerType *>(type)->underlying.get());
+    case MODULE: {
+      auto mod = static_cast<ModuleType *>(type);
+      str(mod->name);
+      return put<uint64_t>(mod->exported);
+    }
+    case FN: {
+      auto fn = static_cast<FnType *>(type);
+      put<uint8_t>(fn->variadic);
+      put<uint32_t>(fn->params.size());
+      for (const auto &param : fn->params) {
+        str(utils::symbol_str(param.name));
+        this->type(param.type.get());
+      }
+
+      return this->type(fn->returns.get());
+    }
+    case STRUCT: {
+      auto [it, inserted] = structs.try_emplace(type, structs.size());
+      if (!inserted) {
+        put<uint8_t>(STRUCT_REF);
+        return put<uint32_t>(it->second);
+      }
+
+      auto s = static_cast<StructType *>(type);
+      put<uint8_t>(0);
+      str(s->module);
+      str(s->name);
+
+      vector<string> members;
+      for (auto member : s->publicMembers) {
+        members.push_back(utils::symbol_name(member));
+      }
+
+      std::sort(members.begin(), members.end());
+      put<uint32_t>(members.size());
+      for (const auto &member : members) {
+        str(member);
+      }
+
+      table(s->staticProperties);
+      table(s->staticMethods);
+      table(s->properties);
+      return table(s->methods);
+    }
+    default:
+      failed = true;
+    }
+  }
+};
+
+struct Reader {
+  const char *pos;
+  const char *end;
+  bool failed = false;
+  vector<shared_ptr<StructType>> structs;
+
+  Reader(string_view data) : pos(data.data()), end(data.data() + data.length()) {
+  }
+
+  template <typename T> T get() {
+    T value{};
+    if ((size_t)(end - pos) < sizeof(T)) {
+      failed = true;
+      pos = end;
+      return value;
+    }
+
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+
+  uint32_t count() {
+    uint32_t n = get<uint32_t>();
+    if (n > (size_t)(end - pos)) {
+      failed = true;
+      return 0;
+    }
+
+    return n;
+  }
+
+  string str() {
+    uint32_t length = count();
+    string s(pos, length);
+    pos += length;
+    return s;
+  }
+
+  utils::SymbolId symbol() {
+    return utils::intern(str());
+  }
+
+  template <typename T> void table(unordered_map<utils::SymbolId, shared_ptr<T>> &map) {
+    for (uint32_t i = 0, n = count(); i < n && !failed; i++) {
+      auto name = symbol();
+      auto t = type();
+
+      if constexpr (std::is_same_v<T, FnType>) {
+        if (!t || t->kind != FN) {
+          failed = true;
+          return;
+        }
+
+        map[name] = std::static_pointer_cast<FnType>(t);
+      } else {
+        map[name] = t;
+      }
+    }
+  }
+
+  shared_ptr<Type> type() {
+    uint8_t kind = get<uint8_t>();
+
+    switch (kind) {
+    case NUMBER:
+      return MK_NUM();
+    case STRING:
+      return MK_STR();
+    case BOOL:
+      return MK_BOOL();
+    case VOID:
+      return MK_VOID();
+    case POINTER: {
+      auto underlying = type();
+      return underlying ? MK_PTR(underlying) : nullptr;
+    }
+    case MODULE: {
+      // A module type carries the members of another summary, which is not stored alongside. A module exporting one
+      // is checked again every run instead.
+      failed = true;
+      return nullptr;
+    }
+    case FN: {
+      bool variadic = get<uint8_t>();
+      vector<FnParam> params;
+      for (uint32_t i = 0, n = count(); i < n && !failed; i++) {
+        auto name = symbol();
+        params.push_back(FnParam(name, type()));
+      }
+
+      auto returns = type();
+      if (failed || !returns) {
+        return nullptr;
+      }
+
+      // Only the signature is summarized. The body belongs to the module's implementation.
+      return MK_FN(params, returns, variadic);
+    }
+    case STRUCT: {
+      if (get<uint8_t>() == STRUCT_REF) {
+        uint32_t index = get<uint32_t>();
+        if (index >= structs.size() || !structs[index]) {
+          failed = true;
+          return nullptr;
+        }
+
+        return structs[index];
+      }
+
+      // A struct is only interned once all its members are read. The checker never lets a struct refer to itself, so a
+      // reference back to one still being read finds nullptr and marks the summary as malformed.
+      size_t index = structs.size();
+      structs.push_back(nullptr);
+      auto module = str();
+      auto s = make_shared<StructType>(module, str());
+
+      for (uint32_t i = 0, n = count(); i < n; i++) {
+        s->publicMembers.insert(symbol());
+      }
+
+      table(s->staticProperties);
+      table(s->staticMethods);
+      table(s->properties);
+      table(s->methods);
+      if (failed) {
+        return nullptr;
+      }
+
+      structs[index] = MK_STRUCT(s);
+      return structs[index];
+    }
+    }
+
+    failed = true;
+    return nullptr;
+  }
+};
+}; // namespace
+
+shared_ptr<Interface> analysis::summarize(ast::ModuleStmt &mod) {
+  auto iface = make_shared<Interface>();
+  iface->module = mod.name;
+  iface->hash = ast::module_hash(mod.file->file_path, mod.file->contents);
+
+  Scope &scope = *mod.scope;
+  for (const auto &[name, exported] : scope.exported) {
+    if (!exported) {
+      continue;
+    }
+
+    if (auto it = scope.symbols.find(name); it != scope.symbols.end()) {
+      iface->symbols[name] = it->second;
+    }
+
+    if (auto it = scope.types.find(name); it != scope.types.end()) {
+      iface->types[name] = it->second;
+    }
+
+    if (scope.constants.count(name) && scope.constants.at(name)) {
+      iface->constants.insert(name);
+    }
+  }
+
+  for (ast::Stmt *s : mod.body) {
+    if (s->kind == ast::IMPORT_STMT) {
+      auto path = static_cast<ast::ImportStmt *>(s)->path;
+      iface->imports[path] = imported_hash(*scope.session, path);
+    }
+  }
+
+  return iface;
+}
+
+string analysis::serialize_interface(const Interface &iface) {
+  Writer w;
+  w.out.append(MAGIC, sizeof(MAGIC));
+  w.put<uint32_t>(FORMAT_VERSION);
+  w.put<uint64_t>(iface.hash);
+  w.str(iface.module);
+
+  w.table(iface.symbols);
+  w.table(iface.types);
+
+  vector<string> constants;
+  for (auto name : iface.constants) {
+    constants.push_back(utils::symbol_name(name));
+  }
+
+  std::sort(constants.begin(), constants.end());
+  w.put<uint32_t>(constants.size());
+  for (const auto &name : constants) {
+    w.str(name);
+  }
+
+  w.put<uint32_t>(iface.imports.size());
+  for (const auto &[module, hash] : iface.imports) {
+    w.str(module);
+    w.put<uint64_t>(hash);
+  }
+
+  return w.failed ? "" : w.out;
+}
+
+uint64_t analysis::exported_hash(const Interface &iface) {
+  Interface exported = iface;
+  exported.hash = 0;
+  exported.imports.clear();
+  return ast::module_hash("", serialize_interface(exported));
+}
+
+uint64_t analysis::imported_hash(const CheckSession &session, const string &module) {
+  auto it = session.interfaces.find(module);
+  return it != session.interfaces.end() ? exported_hash(*it->second) : 0;
+}
+
+string analysis::serialize_type(Type &type) {
+  Writer w;
+  w.type(&type);
+  return w.out;
+}
+
+shared_ptr<Interface> analysis::deserialize_interface(string_view data) {
+  if (data.length() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    return nullptr;
+  }
+
+  Reader r{data.substr(sizeof(MAGIC))};
+  if (r.get<uint32_t>() != FORMAT_VERSION) {
+    return nullptr;
+  }
+
+  auto iface = make_shared<Interface>();
+  iface->hash = r.get<uint64_t>();
+  iface->module = r.str();
+  r.table(iface->symbols);
+  r.table(iface->types);
+
+  for (uint32_t i = 0, n = r.count(); i < n; i++) {
+    iface->constants.insert(r.symbol());
+  }
+
+  for (uint32_t i = 0, n = r.count(); i < n && !r.failed; i++) {
+    auto module = r.str();
+    iface->imports[module] = r.get<uint64_t>();
+  }
+
+  if (r.failed || r.pos != r.end) {
+    return nullptr;
+  }
+
+  return iface;
+}
+
+string analysis::interface_path(const string &file_path) {
+  auto normalized = std::filesystem::path(file_path).lexically_normal().string();
+  return COMPILED_FILES_PATH + "iface/" + utils::sanitize_file_path(normalized) + ".iface";
+}
+
+shared_ptr<Interface> analysis::load_interface(const string &file_path) {
+  auto data = utils::read_file_contents(interface_path(file_path));
+  if (!data.has_value()) {
+    return nullptr;
+  }
+
+  auto iface = deserialize_interface(data.value());
+  if (!iface || iface->module != file_path) {
+    return nullptr;
+  }
+
+  auto source = lexer::SourceFile::open(file_path);
+  if (!source || iface->hash != ast::module_hash(file_path, source->contents)) {
+    return nullptr;
+  }
+
+  return iface;
+}
+
+void analysis::store_interface(const Interface &iface) {
+  string data = serialize_interface(iface);
+  if (data.empty()) {
+    return;
+  }
+
+  // Leaving an unchanged summary alone keeps its timestamp, so tools watching it only see real interface changes.
+  string path = interface_path(iface.module);
+  auto existing = utils::read_file_contents(path);
+  if (existing.has_value() && existing.value() == data) {
+    return;
+  }
+
+  utils::write_file_atomic(path, data);
+}
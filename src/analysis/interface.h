@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../ast/ast_stmt.h"
+#include "types.h"
+
+namespace analysis {
+/// @brief Exported surface of a module: the types of its top level functions and constants and the structs it
+/// declares. A summary stored by an earlier run stands in for a module inside an import cycle, tells parser::parse
+/// whether a check needs the module built at all, and tells tc_program whether its bodies have to be checked again.
+struct Interface {
+  string module;     // name of the summarized module
+  uint64_t hash = 0; // ast::module_hash of the source the summary was built from
+  unordered_map<utils::SymbolId, shared_ptr<Type>> symbols;
+  unordered_map<utils::SymbolId, shared_ptr<Type>> types;
+  set<utils::SymbolId> constants;
+  map<string, uint64_t> imports; // imported_hash of every module this one imports, taken when it was checked
+};
+
+/// @brief Builds the interface of a checked module from the exported entries of its scope.
+shared_ptr<Interface> summarize(ast::ModuleStmt &mod);
+
+string serialize_interface(const Interface &);
+/// @brief Hash of what importers can see of a module. Unlike Interface::hash it stays the same when only the bodies
+/// of the module's functions change.
+uint64_t exported_hash(const Interface &);
+/// @brief exported_hash of the summary of module which importers see at this point of session, 0 for none.
+uint64_t imported_hash(const CheckSession &session, const string &module);
+/// @brief Encodes a single type the way summaries store it. Equal types give the same bytes in every run.
+string serialize_type(Type &type);
+/// @brief Returns nullptr when data is damaged or was written by another version of the compiler.
+shared_ptr<Interface> deserialize_interface(string_view data);
+
+/// @brief Path of the summary of the module at file_path inside COMPILED_FILES_PATH.
+string interface_path(const string &file_path);
+/// @brief Loads the stored summary of the module at file_path. The source is hashed straight from the file, so the
+/// module does not have to be built. Returns nullptr when there is none or the source changed since it was written.
+shared_ptr<Interface> load_interface(const string &file_path);
+/// @brief Writes iface next to the module snapshots unless an identical summary is already stored.
+void store_interface(const Interface &iface);
+}; // namespace analysis
@@ -0,0 +1,236 @@
+#include "query.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "../ast/cache.h"
+#include "../util/files.h"
+#include "interface.h"
+
+using namespace analysis;
+
+// Layout of the stored queries of a module:
+//   magic[8] format:u32 module:str count:u32 record*
+//   record: kind:u8 name:str input:u64 result:u64 deps:u32 (kind:u8 name:str result:u64)*
+
+namespace {
+constexpr char MAGIC[8] = {'B', 'R', 'Q', 'U', 'E', 'R', 'Y', 0};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+// Query being run by this thread. Modules are checked on separate threads, so each records on its own.
+thread_local QueryRecord *recording = nullptr;
+
+struct Writer {
+  string out;
+
+  template <typename T> void put(T value) {
+    out.append((const char *)&value, sizeof(T));
+  }
+
+  void str(string_view s) {
+    put<uint32_t>(s.length());
+    out += s;
+  }
+
+  void key(const QueryKey &key) {
+    put<uint8_t>(key.kind);
+    str(key.name);
+  }
+};
+
+struct Reader {
+  const char *pos;
+  const char *end;
+  bool failed = false;
+
+  Reader(string_view data) : pos(data.data()), end(data.data() + data.length()) {
+  }
+
+  template <typename T> T get() {
+    T value{};
+    if ((size_t)(end - pos) < sizeof(T)) {
+      failed = true;
+      pos = end;
+      return value;
+    }
+
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+
+  uint32_t count() {
+    uint32_t n = get<uint32_t>();
+    if (n > (size_t)(end - pos)) {
+      failed = true;
+      return 0;
+    }
+
+    return n;
+  }
+
+  string str() {
+    uint32_t length = count();
+    string s(pos, length);
+    pos += length;
+    return s;
+  }
+
+  QueryKey key() {
+    uint8_t kind = get<uint8_t>();
+    if (kind > FN_BODY) {
+      failed = true;
+    }
+
+    return QueryKey{(QueryKind)kind, str()};
+  }
+};
+}; // namespace
+
+void QueryTable::declare(QueryKind kind, utils::SymbolId name, uint64_t result) {
+  QueryRecord &record = current[QueryKey{kind, utils::symbol_name(name)}];
+  record.input = result;
+  record.result = result;
+}
+
+bool QueryTable::reusable(const QueryKey &key, uint64_t input) {
+  auto it = previous.find(key);
+  if (it == previous.end() || it->second.input != input) {
+    return false;
+  }
+
+  for (const auto &[dep, result] : it->second.deps) {
+    auto found = current.find(dep);
+    if (found == current.end() || found->second.result != result) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void QueryTable::resolve_deps(QueryRecord &record) {
+  for (auto &[dep, result] : record.deps) {
+    auto found = current.find(dep);
+    result = found != current.end() ? found->second.result : 0;
+  }
+}
+
+// A module type is serialized with the exported_hash of the summary it was filled from, so it changes whenever what
+// importers can see of the module does.
+uint64_t analysis::fingerprint(Type &type) {
+  return ast::module_hash("", serialize_type(type));
+}
+
+uint64_t analysis::fn_fingerprint(const QueryTable &queries, const ast::FnDeclStmt &fn, Type &signature) {
+  string_view body;
+  if (fn.source_start < fn.source_end && fn.source_end <= queries.source.length()) {
+    body = queries.source.substr(fn.source_start, fn.source_end - fn.source_start);
+  }
+
+  return ast::module_hash(serialize_type(signature), body);
+}
+
+void analysis::record_reads(QueryRecord *record) {
+  recording = record;
+}
+
+void analysis::note_read(QueryKind kind, utils::SymbolId name) {
+  if (!recording) {
+    return;
+  }
+
+  QueryKey key{kind, utils::symbol_name(name)};
+  for (const auto &[dep, _] : recording->deps) {
+    if (dep == key) {
+      return;
+    }
+  }
+
+  recording->deps.emplace_back(std::move(key), 0);
+}
+
+string analysis::serialize_queries(const QueryTable &queries) {
+  Writer w;
+  w.out.append(MAGIC, sizeof(MAGIC));
+  w.put<uint32_t>(FORMAT_VERSION);
+  w.str(queries.module);
+
+  size_t bodies = 0;
+  for (const auto &[key, _] : queries.current) {
+    bodies += key.kind == FN_BODY;
+  }
+
+  w.put<uint32_t>(bodies);
+  for (const auto &[key, record] : queries.current) {
+    if (key.kind != FN_BODY) {
+      continue;
+    }
+
+    w.key(key);
+    w.put<uint64_t>(record.input);
+    w.put<uint64_t>(record.result);
+    w.put<uint32_t>(record.deps.size());
+    for (const auto &[dep, result] : record.deps) {
+      w.key(dep);
+      w.put<uint64_t>(result);
+    }
+  }
+
+  return w.out;
+}
+
+bool analysis::deserialize_queries(string_view data, QueryTable &queries) {
+  if (data.length() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    return false;
+  }
+
+  Reader r{data.substr(sizeof(MAGIC))};
+  if (r.get<uint32_t>() != FORMAT_VERSION || r.str() != queries.module) {
+    return false;
+  }
+
+  std::map<QueryKey, QueryRecord> records;
+  for (uint32_t i = 0, n = r.count(); i < n && !r.failed; i++) {
+    QueryKey key = r.key();
+    QueryRecord &record = records[key];
+    record.input = r.get<uint64_t>();
+    record.result = r.get<uint64_t>();
+
+    for (uint32_t d = 0, deps = r.count(); d < deps && !r.failed; d++) {
+      QueryKey dep = r.key();
+      record.deps.emplace_back(std::move(dep), r.get<uint64_t>());
+    }
+  }
+
+  if (r.failed || r.pos != r.end) {
+    return false;
+  }
+
+  queries.previous = std::move(records);
+  return true;
+}
+
+string analysis::queries_path(const string &file_path) {
+  auto normalized = std::filesystem::path(file_path).lexically_normal().string();
+  return COMPILED_FILES_PATH + "queries/" + utils::sanitize_file_path(normalized) + ".queries";
+}
+
+void analysis::load_queries(QueryTable &queries) {
+  auto data = utils::read_file_contents(queries_path(queries.module));
+  if (data.has_value()) {
+    deserialize_queries(data.value(), queries);
+  }
+}
+
+void analysis::store_queries(const QueryTable &queries) {
+  string path = queries_path(queries.module);
+  string data = serialize_queries(queries);
+
+  auto existing = utils::read_file_contents(path);
+  if (existing.has_value() && existing.value() == data) {
+    return;
+  }
+
+  utils::write_file_atomic(path, data);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <map>
+
+#include "../ast/ast_stmt.h"
+#include "types.h"
+
+namespace analysis {
+/// @brief What a query works out about a top level declaration of a module.
+enum QueryKind : uint8_t {
+  DECL_TYPE,     // type of a fn, constant or import. For a fn only its signature, which is all its callers check
+  STRUCT_LAYOUT, // members of a struct
+  FN_BODY,       // whether the body of a fn checks
+};
+
+/// @brief A query is keyed by its kind and the name of its declaration inside the module. Names are kept as text since
+/// interned ids differ between runs.
+struct QueryKey {
+  QueryKind kind;
+  string name;
+
+  auto operator<=>(const QueryKey &) const = default;
+};
+
+/// @brief What a query saw when it last ran. A record of an earlier run is green, so its query need not run again,
+/// while its input is unchanged and every query it read still has the result it read then.
+struct QueryRecord {
+  uint64_t input = 0;                    // fingerprint of the declaration's own source
+  uint64_t result = 0;                   // fingerprint of what the query produced, which its dependents compare
+  vector<pair<QueryKey, uint64_t>> deps; // queries read while this one ran and the result each had
+};
+
+/// @brief Memoized queries of one module. Declarations are checked top to bottom, so a query only reads queries which
+/// were recorded before it in the same run. DECL_TYPE and STRUCT_LAYOUT are cheap and run every time, which gives
+/// the results FN_BODY records are compared against. Only FN_BODY is reused and only its records are stored.
+struct QueryTable {
+  string module;
+  string_view source;       // contents of the module's file
+  bool reuse = false;       // whether green bodies are skipped. Only when nothing is compiled, see tc_program
+  size_t checked = 0;       // bodies checked this run
+  size_t reused = 0;        // bodies skipped as green this run
+  std::map<QueryKey, QueryRecord> previous; // FN_BODY records of the last run which passed
+  std::map<QueryKey, QueryRecord> current;
+
+  /// @brief Records a query which always runs, so its input is its result.
+  void declare(QueryKind kind, utils::SymbolId name, uint64_t result);
+  /// @brief Whether the previous record of key is green for input, given the queries recorded so far this run, so
+  /// its query can be skipped.
+  bool reusable(const QueryKey &key, uint64_t input);
+  /// @brief Fills in the results of the queries record read, once every one of them was recorded this run.
+  void resolve_deps(QueryRecord &record);
+};
+
+/// @brief Fingerprint of a type which is the same in every run. A module is fingerprinted by its summary.
+uint64_t fingerprint(Type &type);
+/// @brief Fingerprint of the signature of a fn and the source of its body, see FnDeclStmt::source_start.
+uint64_t fn_fingerprint(const QueryTable &queries, const ast::FnDeclStmt &fn, Type &signature);
+
+/// @brief Records every query the calling thread reads into record until it is called again with nullptr.
+void record_reads(QueryRecord *record);
+/// @brief Notes a read of the query of kind for name, when the calling thread is recording.
+void note_read(QueryKind kind, utils::SymbolId name);
+
+string serialize_queries(const QueryTable &queries);
+/// @brief Reads the records stored in data into queries->previous. Returns false when data is damaged or was written
+/// by another version of the compiler.
+bool deserialize_queries(string_view data, QueryTable &queries);
+
+/// @brief Path of the queries of the module at file_path inside COMPILED_FILES_PATH.
+string queries_path(const string &file_path);
+/// @brief Loads the records stored by the last run into queries.previous, if there are any.
+void load_queries(QueryTable &queries);
+void store_queries(const QueryTable &queries);
+}; // namespace analysis
@@ -6,13 +6,41 @@ namespace ast {
 struct Expr;
 struct Stmt;
 struct Type;
+struct FnDeclStmt;
 }; // namespace ast
 
 /// @brief Contains contents for static analysis and typechecking.
 namespace analysis {
-struct Type; // forward declare type.
+struct Type;      // forward declare type.
+struct Interface;  // forward declare interface.
+struct QueryTable; // forward declare query table.
 
-struct Scope {
+/// @brief Where the value of a symbol lives at runtime. Analysis records it on every SymbolExpr, so codegen emits loads
+/// without looking names up.
+struct Binding {
+  enum Kind : uint8_t {
+    UNBOUND, // the expression was never analysed
+    GLOBAL,  // defined by the global scope, slot indexes the globals of the program
+    MODULE,  // defined at the top level of a module, slot indexes the globals of that module
+    LOCAL,   // defined inside a function, slot indexes its frame
+  };
+
+  Kind kind = UNBOUND;
+  uint16_t depth = 0; // LOCAL only: function frames between the use and the definition, 0 inside the same function
+  uint32_t slot = 0;
+};
+
+struct Scope;
+
+/// @brief What one tc_program shares between the modules it checks: the global scope and the summaries importers see.
+/// Each call owns its own, so programs checked at the same time never see each other's state. Scopes reach it through
+/// their module, see Scope::get_module.
+struct CheckSession {
+  shared_ptr<Scope> global;
+  unordered_map<string, shared_ptr<Interface>> interfaces; // module summaries keyed by module name
+};
+
+struct Scope : std::enable_shared_from_this<Scope> {
   shared_ptr<Scope> parent;
   string name;
 
@@ -25,33 +53,48 @@ struct Scope {
   bool is_static;
   bool is_impl;
 
-  // Meta info
-  unordered_map<string, bool> constants;
-  unordered_map<string, bool> exported;
+  // Meta info. Every table is keyed by the interned name of the symbol or type.
+  unordered_map<utils::SymbolId, bool> constants;
+  unordered_map<utils::SymbolId, bool> exported;
+
+  unordered_map<utils::SymbolId, shared_ptr<Type>> types;
+  unordered_map<utils::SymbolId, shared_ptr<Type>> symbols;
 
-  unordered_map<string, shared_ptr<Type>> types;
-  unordered_map<string, shared_ptr<Type>> symbols;
-  unordered_map<string, size_t> local_offsets;
+  // Storage. Global and module scopes number the symbols they define from 0. Any other scope numbers its symbols
+  // within the frame of the function it is in, which starts with the parameters of the function.
+  unordered_map<utils::SymbolId, uint32_t> slots;
+  uint32_t next_slot = 0;
+  uint32_t frame_size = 0; // function scopes only: slots used by the function and every block inside it
+  uint32_t params = 0;     // function scopes only: leading slots of the frame which the caller fills
   vector<shared_ptr<Type>> found_return_types;
+  shared_ptr<QueryTable> queries; // module scopes only, nullptr without AST_CACHE. See query.h
+  bool defer_bodies = false;      // module scopes only: fn bodies are left to the calls which need them, see tc_module
+  unordered_map<utils::SymbolId, ast::FnDeclStmt *> deferred; // module scopes only: deferred fns not called yet
 
-  static unordered_map<string, shared_ptr<Scope>> modules;
-  static shared_ptr<Scope> global;
-  static void debugAllScopes();
+  shared_ptr<CheckSession> session; // module scopes only: the tc_program checking the module
   void debugScope();
 
-  void defineSymbol(string name, shared_ptr<analysis::Type> type, bool constant);
-  void defineSymbol(string name, shared_ptr<analysis::Type> type);
+  /// @brief Defines name in this scope and returns the slot it is stored in.
+  uint32_t defineSymbol(utils::SymbolId name, shared_ptr<analysis::Type> type, bool constant);
+  uint32_t defineSymbol(utils::SymbolId name, shared_ptr<analysis::Type> type);
 
-  void defineType(string name, shared_ptr<analysis::Type> type);
-  bool symbolExists(string name);
-  bool typeExists(string name);
+  void defineType(utils::SymbolId name, shared_ptr<analysis::Type> type);
+  bool symbolExists(utils::SymbolId name);
+  bool typeExists(utils::SymbolId name);
 
   void registerFoundReturnType(shared_ptr<Type>);
 
-  shared_ptr<Type> resolveSymbol(string name);
-  shared_ptr<Type> resolveType(string name);
+  shared_ptr<Type> resolveSymbol(utils::SymbolId name);
+  shared_ptr<Type> resolveType(utils::SymbolId name);
 
-  Scope *resolveSymbolScope(string name);
+  Scope *resolveSymbolScope(utils::SymbolId name);
+  /// @brief Finds where name is stored as seen from this scope. The kind is UNBOUND when name is not defined.
+  Binding bind(utils::SymbolId name);
+  /// @brief The module scope enclosing this scope, or nullptr for scopes outside of a module.
   Scope *get_module();
+  /// @brief The global scope of the check this scope belongs to, or nullptr outside of tc_program.
+  Scope *get_global();
+  /// @brief The innermost function scope enclosing this scope, or nullptr outside of functions.
+  Scope *frame();
 };
 }; // namespace analysis
\ No newline at end of file
@@ -1,36 +1,37 @@
+#include "../ast/dump.h"
 #include "analsyis.h"
 
 using namespace analysis;
 using namespace ast;
 
-shared_ptr<analysis::Type> analysis::tc_expr(shared_ptr<ast::Expr> expr, shared_ptr<analysis::Scope> env) {
+static shared_ptr<analysis::Type> tc_expr_kind(ast::Expr *expr, shared_ptr<analysis::Scope> env) {
   switch (expr->kind) {
   case NUMBER_EXPR:
     return MK_NUM();
   case STRING_EXPR:
     return MK_STR();
   case SYMBOL_EXPR:
-    return tc_symbol_expr(static_cast<SymbolExpr *>(expr.get()), env);
+    return tc_symbol_expr(static_cast<SymbolExpr *>(expr), env);
   case PREFIX_EXPR:
-    return tc_prefix_expr(static_cast<PrefixExpr *>(expr.get()), env);
+    return tc_prefix_expr(static_cast<PrefixExpr *>(expr), env);
   case ASSIGN_EXPR:
-    return tc_assignment_expr(static_cast<AssignmentExpr *>(expr.get()), env);
+    return tc_assignment_expr(static_cast<AssignmentExpr *>(expr), env);
   case BINARY_EXPR:
-    return tc_binary_expr(static_cast<BinaryExpr *>(expr.get()), env);
+    return tc_binary_expr(static_cast<BinaryExpr *>(expr), env);
   case CALL_EXPR:
-    return tc_call_expr(static_cast<CallExpr *>(expr.get()), env);
+    return tc_call_expr(static_cast<CallExpr *>(expr), env);
 
   // Macros
   case LOG_MACRO:
-    return tc_log_macro(static_cast<LogMacro *>(expr.get()), env);
+    return tc_log_macro(static_cast<LogMacro *>(expr), env);
   case FMT_MACRO:
-    return tc_fmt_macro(static_cast<FmtMacro *>(expr.get()), env);
+    return tc_fmt_macro(static_cast<FmtMacro *>(expr), env);
   case STR_MACRO:
-    return tc_str_macro(static_cast<StrMacro *>(expr.get()), env);
+    return tc_str_macro(static_cast<StrMacro *>(expr), env);
   case NUM_MACRO:
-    return tc_num_macro(static_cast<NumMacro *>(expr.get()), env);
+    return tc_num_macro(static_cast<NumMacro *>(expr), env);
   default:
-    expr->debug(0);
+    std::cout << debug_str(expr);
     std::cout << "^^^^^ typechecking for node Unimplimented ^^^^^^\n";
     std::cout << "ASTKind: " << expr->kind << "\n";
     TODO("Unimplimented Typechecking for expr");
@@ -38,14 +39,25 @@ shared_ptr<analysis::Type> analysis::tc_expr(shared_ptr<ast::Expr> expr, shared_
   }
 }
 
+shared_ptr<analysis::Type> analysis::tc_expr(ast::Expr *expr, shared_ptr<analysis::Scope> env) {
+  auto type = tc_expr_kind(expr, env);
+  if (type) {
+    expr->type_id = type->id;
+  }
+
+  return type;
+}
+
 shared_ptr<analysis::Type> analysis::tc_binary_expr(ast::BinaryExpr *expr, shared_ptr<analysis::Scope> env) {
   auto l = tc_expr(expr->left, env);
   auto r = tc_expr(expr->right, env);
-  auto op = expr->operation.kind;
+  return tc_binary_op(l, r, expr->operation.kind);
+}
 
+shared_ptr<analysis::Type> analysis::tc_binary_op(shared_ptr<Type> l, shared_ptr<Type> r, lexer::TokenKind op) {
   if (!types_match(l, r)) {
-    std::cout << "Invalid binary operation of " << l->str() << " " << expr->operation.value << " " << r->str() << "\n";
-    exit(1);
+    diag() << "Invalid binary operation of " << l->str() << " " << lexer::token_text(op) << " " << r->str() << "\n";
+    fail();
   }
 
   // Numeric only operations - * / % < <= > >=
@@ -78,85 +90,78 @@ shared_ptr<analysis::Type> analysis::tc_binary_expr(ast::BinaryExpr *expr, share
     }
   }
 
-  std::cout << "Invalid binary operation of " << l->str() << " " << expr->operation.value << " " << r->str() << "\n";
-  exit(1);
+  diag() << "Invalid binary operation of " << l->str() << " " << lexer::token_text(op) << " " << r->str() << "\n";
+  fail();
 }
 
 shared_ptr<analysis::Type> analysis::tc_call_expr(ast::CallExpr *expr, shared_ptr<analysis::Scope> env) {
   auto calle = tc_expr(expr->calle, env);
+  vector<shared_ptr<Type>> args;
+
+  for (auto arg : expr->args) {
+    args.push_back(tc_expr(arg, env));
+  }
+
+  if (expr->calle->kind == SYMBOL_EXPR) {
+    tc_deferred_body(static_cast<SymbolExpr *>(expr->calle)->symbol, env);
+  }
+
+  return tc_call(calle, args);
+}
+
+// Only the signature of the callee is checked. Its body was checked where it is declared, see tc_fn_body.
+shared_ptr<analysis::Type> analysis::tc_call(shared_ptr<Type> calle, const vector<shared_ptr<Type>> &args) {
   FnType *fn = AS_FN(calle);
 
   if (calle->kind != analysis::FN) {
-    std::cout << "Invalid call-expression on type " << calle->str() << "\n";
-    exit(1);
+    diag() << "Invalid call-expression on type " << calle->str() << "\n";
+    fail();
   }
 
   // Check expected vs recieved arity
   if (fn->variadic) {
-    std::cout << "Unhandled call expr check variadic function\n";
-    exit(1);
+    diag() << "Unhandled call expr check variadic function\n";
+    fail();
   }
 
-  if (fn->params.size() != expr->args.size()) {
-    std::cout << "Function call " << fn->str() << " expected " << fn->params.size() << " arguments but recieved ";
-    std::cout << expr->args.size() << " arguments instead\n";
-    exit(1);
+  if (fn->params.size() != args.size()) {
+    diag() << "Function call " << fn->str() << " expected " << fn->params.size() << " arguments but recieved ";
+    diag() << args.size() << " arguments instead\n";
+    fail();
   }
 
-  auto fnEnv = make_shared<Scope>();
-  fnEnv->is_function = true;
-  fnEnv->parent = env;
-  fn->body->scope = fnEnv;
-
   // TODO: Handle variadic instantiation
-  // Install Paremeters into body of function
   for (size_t i = 0; i < fn->params.size(); i++) {
     auto param = fn->params[i];
-    auto argType = tc_expr(expr->args[i], fnEnv);
+    auto argType = args[i];
 
     if (!types_match(param.type, argType)) {
-      std::cout << "Param at position " << i << " expected to be " << param.type->str();
-      std::cout << " but recieved " << argType->str() << " instead\n";
-      exit(1);
-    }
-
-    fnEnv->defineSymbol(param.name, param.type);
-  }
-
-  tc_block_stmt(fn->body.get());
-
-  // Validate Return Type
-  bool foundInvalidReturnType = false;
-  for (const auto &foundReturn : fnEnv->found_return_types) {
-    if (!types_match(fn->returns, foundReturn)) {
-      std::cout << "Mismatch return type inside function declaration. Expected a return of ";
-      std::cout << fn->returns->str() << " but recieved " << foundReturn->str() << " instead\n";
-
-      foundInvalidReturnType = true;
+      diag() << "Param at position " << i << " expected to be " << param.type->str();
+      diag() << " but recieved " << argType->str() << " instead\n";
+      fail();
     }
   }
 
-  if (foundInvalidReturnType) {
-    exit(1);
-  }
-
   return fn->returns;
 }
 
 shared_ptr<analysis::Type> analysis::tc_symbol_expr(ast::SymbolExpr *expr, shared_ptr<analysis::Scope> env) {
   auto symbolType = env->resolveSymbol(expr->symbol);
   if (symbolType) {
+    expr->binding = env->bind(expr->symbol);
     return symbolType;
   }
 
-  std::cout << red("ReferenceError ") << cyan(expr->symbol) << " does not exist in scope\n";
-  exit(1);
+  diag() << red("ReferenceError ") << cyan(utils::symbol_name(expr->symbol)) << " does not exist in scope\n";
+  fail();
 }
 
 shared_ptr<analysis::Type> analysis::tc_prefix_expr(ast::PrefixExpr *expr, shared_ptr<analysis::Scope> env) {
   auto rhs = tc_expr(expr->right, env); // &Number
-  auto opKind = expr->operation.kind;
+  return tc_prefix_op(rhs, expr->operation.kind);
+}
 
+shared_ptr<analysis::Type> analysis::tc_prefix_op(shared_ptr<Type> rhs, lexer::TokenKind opKind) {
   switch (opKind) {
   case lexer::AMPERSAND:
     return MK_PTR(rhs);
@@ -177,24 +182,27 @@ shared_ptr<analysis::Type> analysis::tc_prefix_expr(ast::PrefixExpr *expr, share
   }
 
   // If type is not a number invalid operation
-  std::cout << "Invalid prefix operation " << expr->operation.value;
-  std::cout << " with type " << rhs->str() << "\n";
-  exit(1);
+  diag() << "Invalid prefix operation " << lexer::token_text(opKind);
+  diag() << " with type " << rhs->str() << "\n";
+  fail();
 }
 
 shared_ptr<analysis::Type> analysis::tc_assignment_expr(ast::AssignmentExpr *expr, shared_ptr<analysis::Scope> env) {
   auto rhs = tc_expr(expr->value, env);
+  auto [target, varname] = assign_target(expr->assigne);
+  return tc_assignment(target, varname, rhs, env);
+}
 
+shared_ptr<analysis::Type> analysis::tc_assignment(AssignTarget target, utils::SymbolId varname,
+                                                   shared_ptr<Type> rhs, shared_ptr<Scope> env) {
   // varname = Expr | Variable Assignment
-  if (expr->assigne->kind == SYMBOL_EXPR) {
-    string varname = static_cast<SymbolExpr *>(expr->assigne.get())->symbol;
-
+  if (target == ASSIGN_SYMBOL) {
     // Make sure variable exists
     if (!env->symbolExists(varname)) {
-      std::cout << "Invalid assignment operation. ";
-      std::cout << "Variable " << magenta(varname);
-      std::cout << " does not exist.\n";
-      exit(1);
+      diag() << "Invalid assignment operation. ";
+      diag() << "Variable " << magenta(utils::symbol_name(varname));
+      diag() << " does not exist.\n";
+      fail();
     }
 
     auto expectedType = env->resolveSymbol(varname);
@@ -202,52 +210,44 @@ shared_ptr<analysis::Type> analysis::tc_assignment_expr(ast::AssignmentExpr *exp
       return rhs;
     }
 
-    std::cout << "Invalid assignment operation. Variable " << magenta(varname);
-    std::cout << " expected type: " << expectedType->str() << " but";
-    std::cout << " recieved " << rhs->str() << " instead\n";
-    exit(1);
-  }
-
-  // *varname = Expr | Pointer Deference Assignment
-  if (expr->assigne->kind == PREFIX_EXPR) {
-    auto prefix = static_cast<PrefixExpr *>(expr->assigne.get());
-    bool isPtrOperation = prefix->operation.kind == lexer::STAR;
-
-    // *Varname = Expr
-    if (isPtrOperation && prefix->right->kind == SYMBOL_EXPR) {
-      string varname = static_cast<SymbolExpr *>(prefix->right.get())->symbol;
-
-      // Make sure variable exists
-      if (!env->symbolExists(varname)) {
-        std::cout << "Invalid assignment operation. ";
-        std::cout << "Variable " << magenta(varname);
-        std::cout << " does not exist.\n";
-        exit(1);
-      }
-
-      // Make sure variable holds a pointer to T
-      auto ptrType = env->resolveSymbol(varname);
-      if (ptrType->kind != POINTER) {
-        std::cout << "Invalid pointer assignment operation. Variable ";
-        std::cout << varname << " does not hold a pointer\n";
-        exit(1);
-      }
-
-      auto ptrUnderlying = static_cast<PointerType *>(ptrType.get())->underlying;
-      // Verify the rhs type matches that of what varname is pointing too
-      if (types_match(ptrUnderlying, rhs)) {
-        return rhs;
-      }
-
-      std::cout << "Invalid pointer assignment operation. ";
-      std::cout << "Variable " << magenta(varname) << " points to ";
-      std::cout << ptrUnderlying->str() << " but";
-      std::cout << " recieved " << rhs->str() << " instead\n";
-      exit(1);
+    diag() << "Invalid assignment operation. Variable " << magenta(utils::symbol_name(varname));
+    diag() << " expected type: " << expectedType->str() << " but";
+    diag() << " recieved " << rhs->str() << " instead\n";
+    fail();
+  }
+
+  // *Varname = Expr | Pointer Deference Assignment
+  if (target == ASSIGN_DEREF) {
+    // Make sure variable exists
+    if (!env->symbolExists(varname)) {
+      diag() << "Invalid assignment operation. ";
+      diag() << "Variable " << magenta(utils::symbol_name(varname));
+      diag() << " does not exist.\n";
+      fail();
+    }
+
+    // Make sure variable holds a pointer to T
+    auto ptrType = env->resolveSymbol(varname);
+    if (ptrType->kind != POINTER) {
+      diag() << "Invalid pointer assignment operation. Variable ";
+      diag() << utils::symbol_str(varname) << " does not hold a pointer\n";
+      fail();
     }
 
-    std::cout << "Invalid assignment operation. *Varname = Expr expected\n";
-    std::cout << "Invalid prefix on lhs\n";
-    exit(1);
+    auto ptrUnderlying = static_cast<PointerType *>(ptrType.get())->underlying;
+    // Verify the rhs type matches that of what varname is pointing too
+    if (types_match(ptrUnderlying, rhs)) {
+      return rhs;
+    }
+
+    diag() << "Invalid pointer assignment operation. ";
+    diag() << "Variable " << magenta(utils::symbol_name(varname)) << " points to ";
+    diag() << ptrUnderlying->str() << " but";
+    diag() << " recieved " << rhs->str() << " instead\n";
+    fail();
   }
+
+  diag() << "Invalid assignment operation. *Varname = Expr expected\n";
+  diag() << "Invalid prefix on lhs\n";
+  fail();
 }
@@ -0,0 +1,73 @@
+#include "analsyis.h"
+
+using namespace analysis;
+using namespace ast;
+
+// Nodes are in post-order, so by the time a node is reached the types of all of its operands are already in types.
+vector<shared_ptr<analysis::Type>> analysis::tc_flat_exprs(const ast::FlatExprs &exprs, shared_ptr<Scope> env) {
+  vector<shared_ptr<Type>> types(exprs.size());
+  vector<shared_ptr<Type>> args;
+
+  auto list = [&](NodeIndex i) -> const vector<shared_ptr<Type>> & {
+    args.clear();
+    for (uint32_t n = 0; n < exprs.payloads[i]; n++) {
+      args.push_back(types[exprs.lists[exprs.rhs[i] + n]]);
+    }
+    return args;
+  };
+
+  for (NodeIndex i = 0; i < exprs.size(); i++) {
+    switch (exprs.kind(i)) {
+    case NUMBER_EXPR:
+      types[i] = MK_NUM();
+      break;
+    case STRING_EXPR:
+      types[i] = MK_STR();
+      break;
+    case SYMBOL_EXPR: {
+      utils::SymbolId symbol = exprs.payloads[i];
+      types[i] = env->resolveSymbol(symbol);
+
+      if (!types[i]) {
+        diag() << red("ReferenceError ") << cyan(utils::symbol_name(symbol)) << " does not exist in scope\n";
+        fail();
+      }
+      break;
+    }
+    case BINARY_EXPR:
+      types[i] = tc_binary_op(types[exprs.lhs[i]], types[exprs.rhs[i]], (lexer::TokenKind)exprs.payloads[i]);
+      break;
+    case PREFIX_EXPR:
+      types[i] = tc_prefix_op(types[exprs.lhs[i]], (lexer::TokenKind)exprs.payloads[i]);
+      break;
+    case ASSIGN_EXPR:
+      types[i] = tc_assignment((AssignTarget)exprs.payloads[i], exprs.rhs[i], types[exprs.lhs[i]], env);
+      break;
+    case CALL_EXPR:
+      if (exprs.kind(exprs.lhs[i]) == SYMBOL_EXPR) {
+        tc_deferred_body(exprs.payloads[exprs.lhs[i]], env);
+      }
+
+      types[i] = tc_call(types[exprs.lhs[i]], list(i));
+      break;
+    case LOG_MACRO:
+      types[i] = tc_log(types[exprs.lhs[i]]);
+      break;
+    case STR_MACRO:
+      types[i] = tc_str(types[exprs.lhs[i]]);
+      break;
+    case NUM_MACRO:
+      types[i] = tc_num(types[exprs.lhs[i]]);
+      break;
+    case FMT_MACRO:
+      types[i] = tc_fmt(exprs.strings[exprs.lhs[i]], list(i));
+      break;
+    default:
+      std::cout << "ASTKind: " << exprs.kind(i) << "\n";
+      TODO("Unimplimented Typechecking for flat expr");
+      break;
+    }
+  }
+
+  return types;
+}
@@ -1,32 +1,67 @@
+#include <optional>
+#include <sstream>
+
 #include "../ast/ast_stmt.h"
+#include "../ast/dump.h"
+#include "../parser/parser.h"
+#include "../util/thread_pool.h"
 #include "analsyis.h"
+#include "interface.h"
+#include "query.h"
 #include "types.h"
 
 using namespace analysis;
 using namespace ast;
 
+// Set while tc_program checks a module, see check_module.
+static thread_local std::ostringstream *diag_buffer = nullptr;
+
+std::ostream &analysis::diag() {
+  return diag_buffer ? *diag_buffer : std::cout;
+}
+
+void analysis::fail() {
+  if (diag_buffer) {
+    throw CheckFailed{};
+  }
+
+  exit(1);
+}
+
+// Skipped and cached bodies are built here, while their module is checked, so a syntax error inside one may come up
+// on the thread pool.
+ast::BlockStmt *analysis::body_of(ast::FnDeclStmt *fn) {
+  try {
+    return parser::fn_body(fn);
+  } catch (Err err) {
+    diag() << err.str();
+    fail();
+  }
+}
+
 shared_ptr<Scope> createGlobalScope() {
   auto env = make_shared<Scope>();
   env->is_global = true;
   env->name = "global";
 
   // Define Types
-  env->defineType("Bool", MK_BOOL());
-  env->defineType("Number", MK_NUM());
-  env->defineType("Void", MK_VOID());
-  env->defineType("String", MK_STR());
+  env->defineType(utils::intern("Bool"), MK_BOOL());
+  env->defineType(utils::intern("Number"), MK_NUM());
+  env->defineType(utils::intern("Void"), MK_VOID());
+  env->defineType(utils::intern("String"), MK_STR());
 
   // Define program object
-  auto p = MK_STRUCT("BedrockProgram");
-  p->properties["argc"] = MK_NUM();
-  p->properties["cwd"] = MK_STR();
+  auto p = make_shared<StructType>(env->name, "BedrockProgram");
+  p->properties[utils::intern("argc")] = MK_NUM();
+  p->properties[utils::intern("cwd")] = MK_STR();
+  p = MK_STRUCT(p);
 
-  env->defineType("BedrockProgram", p);
-  env->defineSymbol("program", p, true);
+  env->defineType(utils::intern("BedrockProgram"), p);
+  env->defineSymbol(utils::intern("program"), p, true);
 
   // Define Global Variables
-  env->defineSymbol("true", MK_BOOL(), true);
-  env->defineSymbol("false", MK_BOOL(), true);
+  env->defineSymbol(utils::intern("true"), MK_BOOL(), true);
+  env->defineSymbol(utils::intern("false"), MK_BOOL(), true);
 
   // Define Modules
 
@@ -37,34 +72,235 @@ shared_ptr<Scope> createGlobalScope() {
   return env;
 }
 
-shared_ptr<analysis::Type> analysis::tc_program(shared_ptr<ast::ProgramStmt> stmt) {
-  Scope::global = createGlobalScope();
+// Groups the modules of a program by import depth. A module sits one level above the deepest module it imports, so
+// modules of the same level never import each other. Imports of a module which come later in stmt->modules close an
+// import cycle and are not counted.
+static vector<vector<shared_ptr<ModuleStmt>>> import_levels(ProgramStmt &program) {
+  unordered_map<string, size_t> level_of;
+  vector<vector<shared_ptr<ModuleStmt>>> levels;
+
+  for (const auto &module : program.modules) {
+    size_t level = 0;
+    for (Stmt *s : module->body) {
+      if (s->kind != IMPORT_STMT) {
+        continue;
+      }
+
+      if (auto it = level_of.find(static_cast<ImportStmt *>(s)->path); it != level_of.end()) {
+        level = std::max(level, it->second + 1);
+      }
+    }
+
+    level_of[module->name] = level;
+    levels.resize(std::max(levels.size(), level + 1));
+    levels[level].push_back(module);
+  }
+
+  return levels;
+}
+
+// A module is settled when its source and the summaries of the modules it imports are the same as when its stored
+// summary was written. Only modules whose bodies were all checked store a summary, so the bodies of a settled module
+// passed against exactly what they see now. Only check_only settles modules, since a compiled program needs every
+// body, and the entry is always checked.
+static bool settled(const ModuleStmt &module, const CheckSession &session, bool check_only,
+                    const unordered_map<string, shared_ptr<Interface>> &stored) {
+  auto it = stored.find(module.name);
+  if (!check_only || module.is_entry || it == stored.end()) {
+    return false;
+  }
 
-  for (const auto &module : stmt->modules) {
-    tc_module(module);
+  for (const auto &[path, hash] : it->second->imports) {
+    if (imported_hash(session, path) != hash) {
+      return false;
+    }
   }
 
-  Scope::debugAllScopes();
+  return true;
+}
+
+// Checks a module with its errors written to a buffer of its own. Returns the errors of a module which failed, nothing
+// for a module which passed.
+static std::optional<string> check_module(shared_ptr<ModuleStmt> module, shared_ptr<CheckSession> session,
+                                          bool check_only, bool settled) {
+  std::ostringstream messages;
+  diag_buffer = &messages;
+
+  try {
+    tc_module(module, session, check_only, settled);
+    diag_buffer = nullptr;
+    return std::nullopt;
+  } catch (CheckFailed) {
+    diag_buffer = nullptr;
+    record_reads(nullptr); // the failed fn may have been recording
+    return messages.str();
+  }
+}
+
+// Checks the modules of one level on the thread pool. Once the whole level is done every module which failed is
+// reported in program order, so the report is the same whichever worker finished first and however the level was
+// scheduled. --typeinfo prints scopes as they are checked, so it keeps to the calling thread. With a single worker
+// the pool cannot run anything alongside the calling thread, so handing it the level would only add the queueing.
+static void check_level(const vector<shared_ptr<ModuleStmt>> &level, shared_ptr<CheckSession> session, bool check_only,
+                        const unordered_map<string, shared_ptr<Interface>> &stored) {
+  vector<std::optional<string>> results;
+
+  if (level.size() == 1 || DISPLAY_TYPEINFO || utils::thread_pool().size() == 1) {
+    for (const auto &module : level) {
+      results.push_back(check_module(module, session, check_only, settled(*module, *session, check_only, stored)));
+    }
+  } else {
+    vector<std::future<std::optional<string>>> checks;
+    for (const auto &module : level) {
+      bool unchanged = settled(*module, *session, check_only, stored);
+      auto check = [=]() { return check_module(module, session, check_only, unchanged); };
+      checks.push_back(utils::thread_pool().submit(check));
+    }
+
+    for (auto &check : checks) {
+      results.push_back(check.get());
+    }
+  }
+
+  bool failed = false;
+  for (const auto &messages : results) {
+    if (messages) {
+      std::cout << *messages;
+      failed = true;
+    }
+  }
+
+  if (failed) {
+    exit(1);
+  }
+}
+
+shared_ptr<analysis::Type> analysis::tc_program(shared_ptr<ast::ProgramStmt> stmt, bool check_only) {
+  auto session = make_shared<CheckSession>();
+  session->global = createGlobalScope();
+
+  // Imports are checked before their importers, so an importer normally sees the summary built this run. Inside an
+  // import cycle it does not exist yet, and the summary stored by an earlier run stands in for it.
+  unordered_map<string, shared_ptr<Interface>> stored;
+  if (AST_CACHE) {
+    for (const auto &module : stmt->modules) {
+      if (auto iface = load_interface(module->name)) {
+        stored[module->name] = iface;
+        session->interfaces[module->name] = iface;
+      }
+    }
+  }
+
+  // Modules which were never built have nothing to check, their stored summary is all importers see of them.
+  for (const auto &[name, iface] : stmt->summaries) {
+    session->interfaces[name] = iface;
+  }
+
+  // Workers only read the global scope and the summaries. Summaries are published between levels and in program order,
+  // so every importer sees the same ones however its level was scheduled.
+  for (const auto &level : import_levels(*stmt)) {
+    check_level(level, session, check_only, stored);
+
+    for (const auto &module : level) {
+      auto iface = summarize(*module);
+      session->interfaces[module->name] = iface;
+
+      // Deferred bodies were not checked and left no records, so the summary and records of the module's last full
+      // check are kept. See settled.
+      if (AST_CACHE && !module->scope->defer_bodies) {
+        store_interface(*iface);
+        store_queries(*module->scope->queries);
+      }
+    }
+  }
+
+  session->global->debugScope();
   return MK_VOID();
 }
 
-shared_ptr<analysis::Type> analysis::tc_module(shared_ptr<ast::ModuleStmt> stmt) {
+// Top level functions, structs and constants make up the interface of a module. See summarize.
+static void mark_exported(Stmt *stmt, Scope &env) {
+  switch (stmt->kind) {
+  case FN_DECL_STMT:
+    env.exported[static_cast<FnDeclStmt *>(stmt)->name] = true;
+    return;
+  case STRUCT_STMT:
+    env.exported[static_cast<StructStmt *>(stmt)->name] = true;
+    return;
+  case VAR_DECL_STMT: {
+    auto decl = static_cast<VarDeclStmt *>(stmt);
+    if (decl->constant) {
+      env.exported[decl->varname] = true;
+      env.constants[decl->varname] = true;
+    }
+    return;
+  }
+  default:
+    return;
+  }
+}
+
+// Records the queries which always run for the declarations of a top level statement. Fns record their own while
+// they are checked, since their body reads its own type.
+static void declare_queries(Stmt *stmt, Scope &env) {
+  QueryTable &queries = *env.queries;
+
+  switch (stmt->kind) {
+  case VAR_DECL_STMT: {
+    auto name = static_cast<VarDeclStmt *>(stmt)->varname;
+    return queries.declare(DECL_TYPE, name, fingerprint(*env.symbols[name]));
+  }
+  case IMPORT_STMT: {
+    auto alias = static_cast<ImportStmt *>(stmt)->alias;
+    return queries.declare(DECL_TYPE, alias, fingerprint(*env.symbols[alias]));
+  }
+  case STRUCT_STMT: {
+    auto name = static_cast<StructStmt *>(stmt)->name;
+    return queries.declare(STRUCT_LAYOUT, name, fingerprint(*env.types[name]));
+  }
+  default:
+    return;
+  }
+}
+
+shared_ptr<analysis::Type> analysis::tc_module(shared_ptr<ast::ModuleStmt> stmt, shared_ptr<CheckSession> session,
+                                               bool check_only, bool settled) {
   auto env = make_shared<Scope>();
 
   env->is_entry = stmt->is_entry;
   env->is_module = true;
   env->name = stmt->name;
+  env->session = session;
+
+  // Importers only read the signatures of a module's fns, so with --lazy-bodies the bodies of imported modules are not
+  // built until something calls them. `bedrock check` is run to find errors, so it checks every body of a module
+  // which is not settled.
+  env->defer_bodies = settled || (LAZY_FN_BODIES && !check_only && !stmt->is_entry);
+
+  if (AST_CACHE) {
+    env->queries = make_shared<QueryTable>();
+    env->queries->module = stmt->name;
+    env->queries->source = stmt->file->contents;
+    env->queries->reuse = check_only;
+    load_queries(*env->queries);
+  }
 
   stmt->scope = env;
   for (const auto &s : stmt->body) {
     tc_stmt(s, stmt->scope);
+    mark_exported(s, *env);
+
+    if (env->queries) {
+      declare_queries(s, *env);
+    }
   }
 
   // Verify main function found inside entry_module
-  bool mainFound = env->symbolExists("main") && env->resolveSymbol("main")->kind == analysis::FN;
+  auto main = utils::intern("main");
+  bool mainFound = env->symbolExists(main) && env->resolveSymbol(main)->kind == analysis::FN;
   if (env->is_entry && !mainFound) {
-    std::cout << "Missing fn main() inside main module\n";
-    exit(1);
+    diag() << "Missing fn main() inside main module\n";
+    fail();
   }
 
   stmt->scope->debugScope();
@@ -76,88 +312,143 @@ shared_ptr<analysis::Type> analysis::tc_var_decl_stmt(VarDeclStmt *stmt, shared_
   auto vartype = stmt->type ? tc_type(stmt->type, env) : nullptr;
 
   if (env->symbolExists(varname)) {
-    printf("Variable already exists in the current scope %s\n", varname.c_str());
-    exit(1);
+    diag() << "Variable already exists in the current scope " << utils::symbol_name(varname) << "\n";
+    fail();
   }
 
   // No initial value
   if (vartype && !stmt->value) {
-    env->defineSymbol(varname, vartype);
+    stmt->slot = env->defineSymbol(varname, vartype);
     return vartype;
   }
 
   auto recievedType = tc_expr(stmt->value, env);
 
-  // If local variable determine local_offset for comtime
-  if (!env->is_global && !env->is_module) {
-    size_t offset = env->local_offsets.size();
-    env->local_offsets[varname] = offset;
-  }
-
   // Infer type usage
   if (!vartype && recievedType) {
-    env->defineSymbol(varname, recievedType);
+    stmt->slot = env->defineSymbol(varname, recievedType);
     return recievedType;
   }
 
   // Check expected is recieved
   if (types_match(vartype, recievedType)) {
-    env->defineSymbol(varname, vartype);
+    stmt->slot = env->defineSymbol(varname, vartype);
     return vartype;
   }
 
-  printf("Variable declation for %s expected %s but recieved %s instead.\n", varname.c_str(), vartype->str().c_str(),
-         recievedType->str().c_str());
-  exit(1);
+  diag() << "Variable declation for " << utils::symbol_name(varname) << " expected " << vartype->str();
+  diag() << " but recieved " << recievedType->str() << " instead.\n";
+  fail();
 }
 
 shared_ptr<analysis::Type> analysis::tc_fn_decl_stmt(FnDeclStmt *stmt, shared_ptr<Scope> env) {
   auto fnname = stmt->name;
   auto returns = stmt->return_type ? tc_type(stmt->return_type, env) : MK_VOID();
-  auto fnEnv = make_shared<Scope>();
   auto params = vector<FnParam>();
 
-  fnEnv->parent = env;
-  fnEnv->is_function = true;
-  fnEnv->name = env->name + "." + fnname + "()";
-
   // Make sure function does not already exist
   if (env->resolveSymbol(fnname)) {
-    printf("Function %s redeclared. Cannot have multiple declarations of "
-           "the same "
-           "function.",
-           fnname.c_str());
-    exit(1);
+    diag() << "Function " << utils::symbol_name(fnname) << " redeclared. ";
+    diag() << "Cannot have multiple declarations of the same function.";
+    fail();
   }
 
-  // Build Parameters
   for (const auto &param : stmt->params) {
-    auto paramType = tc_type(param.type, env);
-    fnEnv->defineSymbol(param.name, paramType, true);
-    params.push_back(FnParam(param.name, paramType));
+    params.push_back(FnParam(param.name, tc_type(param.type, env)));
   }
 
-  auto fn = MK_FN(params, returns, false, stmt->body);
+  auto fn = MK_FN(params, returns, false);
   env->defineSymbol(fnname, fn);
-  stmt->body->scope = fnEnv;
-  tc_block_stmt(stmt->body.get());
+
+  // The first call checks the body instead, see tc_deferred_body. Codegen skips a body which was never checked.
+  if (env->defer_bodies) {
+    env->deferred[fnname] = stmt;
+    return MK_VOID();
+  }
+
+  // Top level fns are queries of their module. Callers only check their arguments against the signature, so that is
+  // all the type they read covers. The body is fingerprinted from its source, so a body which is reused is never
+  // built.
+  QueryTable *queries = env->is_module ? env->queries.get() : nullptr;
+  QueryRecord record;
+  QueryKey key{FN_BODY, utils::symbol_name(fnname)};
+
+  if (queries) {
+    record.input = fn_fingerprint(*queries, *stmt, *fn);
+    queries->declare(DECL_TYPE, fnname, fingerprint(*fn));
+
+    if (queries->reuse && queries->reusable(key, record.input)) {
+      queries->current[key] = queries->previous[key];
+      queries->reused++;
+      return MK_VOID();
+    }
+
+    queries->checked++;
+    record_reads(&record);
+  }
+
+  tc_fn_body(stmt, *fn, env);
+
+  if (queries) {
+    record_reads(nullptr);
+    queries->resolve_deps(record);
+    queries->current[key] = std::move(record);
+  }
+
+  return MK_VOID();
+}
+
+void analysis::tc_fn_body(FnDeclStmt *stmt, FnType &fn, shared_ptr<Scope> env) {
+  auto fnname = stmt->name;
+  auto fnEnv = make_shared<Scope>();
+
+  fnEnv->parent = env;
+  fnEnv->is_function = true;
+  fnEnv->name = env->name + "." + utils::symbol_name(fnname) + "()";
+
+  // Parameters take the first slots of the frame.
+  fnEnv->params = fn.params.size();
+  for (const auto &param : fn.params) {
+    fnEnv->defineSymbol(param.name, param.type, true);
+  }
+
+  auto body = body_of(stmt);
+  body->scope = fnEnv;
+  tc_block_stmt(body);
 
   // Check Return Types
   bool foundError = false;
   for (const auto &foundReturn : fnEnv->found_return_types) {
-    if (!types_match(returns, foundReturn)) {
-      std::cout << "Mismatch return types for function " << fnname << " expected " << returns->str() << " ";
-      std::cout << "but recieved " << foundReturn->str() << " instead\n";
+    if (!types_match(fn.returns, foundReturn)) {
+      diag() << "Mismatch return types for function " << utils::symbol_str(fnname);
+      diag() << " expected " << fn.returns->str() << " ";
+      diag() << "but recieved " << foundReturn->str() << " instead\n";
       foundError = true;
     }
   }
 
   if (foundError) {
-    exit(1);
+    fail();
   }
 
   fnEnv->debugScope();
-  return MK_VOID();
+}
+
+void analysis::tc_deferred_body(utils::SymbolId callee, shared_ptr<Scope> env) {
+  Scope *owner = env->resolveSymbolScope(callee);
+  if (!owner) {
+    return;
+  }
+
+  auto it = owner->deferred.find(callee);
+  if (it == owner->deferred.end()) {
+    return;
+  }
+
+  // Taken out first, so a recursive call inside the body does not check it again.
+  FnDeclStmt *stmt = it->second;
+  owner->deferred.erase(it);
+  tc_fn_body(stmt, *AS_FN(owner->symbols[callee]), owner->shared_from_this());
 }
 
 shared_ptr<analysis::Type> analysis::tc_block_stmt(BlockStmt *stmt) {
@@ -178,15 +469,37 @@ shared_ptr<analysis::Type> analysis::tc_return_stmt(ReturnStmt *stmt, shared_ptr
   return rhs;
 }
 
+// Importers only ever see the summary of the imported module, never its scope. See tc_program for where it comes from.
+shared_ptr<analysis::Type> analysis::tc_import_stmt(ImportStmt *stmt, shared_ptr<Scope> env) {
+  if (env->symbolExists(stmt->alias)) {
+    diag() << "Cannot import module as " << utils::symbol_str(stmt->alias);
+    diag() << " as a symbol with this name already exists\n";
+    fail();
+  }
+
+  // Inside an import cycle without a stored summary there is nothing to fill it from yet, so it has no members.
+  auto mod = make_shared<ModuleType>(stmt->path);
+  auto &interfaces = env->get_module()->session->interfaces;
+  if (auto it = interfaces.find(stmt->path); it != interfaces.end()) {
+    mod->exported = exported_hash(*it->second);
+    mod->symbols = it->second->symbols;
+    mod->types = it->second->types;
+  }
+
+  mod = MK_MODULE(mod);
+  env->defineSymbol(stmt->alias, mod, true);
+  return mod;
+}
+
 shared_ptr<analysis::Type> analysis::tc_struct_stmt(StructStmt *stmt, shared_ptr<Scope> env) {
   auto name = stmt->name;
-  auto s = MK_STRUCT(name);
+  auto s = make_shared<StructType>(env->name, utils::symbol_name(name));
 
   // Verify name does not already exist
   if (env->typeExists(name)) {
-    std::cout << "Cannot define struct " << name;
-    std::cout << " as a type with this name already exists\n";
-    exit(1);
+    diag() << "Cannot define struct " << utils::symbol_str(name);
+    diag() << " as a type with this name already exists\n";
+    fail();
   }
 
   // Install & Validate Properties
@@ -196,10 +509,10 @@ shared_ptr<analysis::Type> analysis::tc_struct_stmt(StructStmt *stmt, shared_ptr
 
     // Name is already in use
     if (s->hasField(propName)) {
-      std::cout << "Struct " << name << " ";
-      std::cout << "already has a property with ";
-      std::cout << "the name " << propName << "\n";
-      exit(1);
+      diag() << "Struct " << utils::symbol_str(name) << " ";
+      diag() << "already has a property with ";
+      diag() << "the name " << utils::symbol_str(propName) << "\n";
+      fail();
     }
 
     if (prop.is_static) {
@@ -215,31 +528,43 @@ shared_ptr<analysis::Type> analysis::tc_struct_stmt(StructStmt *stmt, shared_ptr
 
   // Add struct to current scope if inside module or global
   if (env->is_module || env->is_global) {
+    s = MK_STRUCT(s);
     env->defineType(name, s);
     return s;
   }
 
-  std::cout << "Struct " << name << " ";
-  std::cout << "cannot be declared in current scope\n";
-  exit(1);
+  diag() << "Struct " << utils::symbol_str(name) << " ";
+  diag() << "cannot be declared in current scope\n";
+  fail();
 }
 
-shared_ptr<analysis::Type> analysis::tc_stmt(shared_ptr<ast::Stmt> stmt, shared_ptr<Scope> env) {
+static shared_ptr<analysis::Type> tc_stmt_kind(ast::Stmt *stmt, shared_ptr<Scope> env) {
   switch (stmt->kind) {
   case VAR_DECL_STMT:
-    return tc_var_decl_stmt(static_cast<VarDeclStmt *>(stmt.get()), env);
+    return tc_var_decl_stmt(static_cast<VarDeclStmt *>(stmt), env);
   case FN_DECL_STMT:
-    return tc_fn_decl_stmt(static_cast<FnDeclStmt *>(stmt.get()), env);
+    return tc_fn_decl_stmt(static_cast<FnDeclStmt *>(stmt), env);
   case EXPR_STMT:
-    return tc_expr_stmt(static_cast<ExprStmt *>(stmt.get()), env);
+    return tc_expr_stmt(static_cast<ExprStmt *>(stmt), env);
   case STRUCT_STMT:
-    return tc_struct_stmt(static_cast<StructStmt *>(stmt.get()), env);
+    return tc_struct_stmt(static_cast<StructStmt *>(stmt), env);
   case RETURN_STMT:
-    return tc_return_stmt(static_cast<ReturnStmt *>(stmt.get()), env);
+    return tc_return_stmt(static_cast<ReturnStmt *>(stmt), env);
+  case IMPORT_STMT:
+    return tc_import_stmt(static_cast<ImportStmt *>(stmt), env);
   default:
-    stmt->debug(0);
+    std::cout << debug_str(stmt);
     std::cout << "^^^^^ typechecking for node Unimplimented ^^^^^^\n";
     std::cout << "ASTKind: " << stmt->kind << "\n";
     TODO("Unimplimented Typechecking for stmt");
   }
 }
+
+shared_ptr<analysis::Type> analysis::tc_stmt(ast::Stmt *stmt, shared_ptr<Scope> env) {
+  auto type = tc_stmt_kind(stmt, env);
+  if (type) {
+    stmt->type_id = type->id;
+  }
+
+  return type;
+}
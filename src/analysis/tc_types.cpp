@@ -1,28 +1,38 @@
+#include "../ast/dump.h"
 #include "analsyis.h"
 
 using namespace analysis;
 using namespace ast;
 
-shared_ptr<analysis::Type> analysis::tc_type(shared_ptr<ast::Type> type, shared_ptr<analysis::Scope> env) {
+static shared_ptr<analysis::Type> tc_type_kind(ast::Type *type, shared_ptr<analysis::Scope> env) {
   switch (type->kind) {
   case SYMBOL_TYPE: {
-    auto typeName = static_cast<SymbolType *>(type.get())->symbol;
+    auto typeName = static_cast<SymbolType *>(type)->symbol;
     auto foundType = env->resolveType(typeName);
 
     if (!foundType) {
-      printf("Type %s does not exist.\n", typeName.c_str());
-      exit(1);
+      diag() << "Type " << utils::symbol_name(typeName) << " does not exist.\n";
+      fail();
     }
 
     return foundType;
   }
   case POINTER_TYPE:
-    return MK_PTR(tc_type(static_cast<ast::PointerType *>(type.get())->type, env));
+    return MK_PTR(tc_type(static_cast<ast::PointerType *>(type)->type, env));
 
   default:
-    type->debug(0);
+    std::cout << debug_str(type);
     std::cout << "^^^^^ typechecking for node Unimplimented ^^^^^^\n";
     TODO("Unimplimented Typechecking for type");
     break;
   }
 }
+
+shared_ptr<analysis::Type> analysis::tc_type(ast::Type *type, shared_ptr<analysis::Scope> env) {
+  auto resolved = tc_type_kind(type, env);
+  if (resolved) {
+    type->type_id = resolved->id;
+  }
+
+  return resolved;
+}
@@ -1,12 +1,56 @@
 #include "types.h"
+
+#include <algorithm>
+#include <mutex>
+
 #include "../ast/ast_stmt.h"
 
 using namespace analysis;
 
-static shared_ptr<VoidType> SHARED_VOID = make_shared<VoidType>();
-static shared_ptr<StringType> SHARED_STRING = make_shared<StringType>();
-static shared_ptr<NumberType> SHARED_NUMBER = make_shared<NumberType>();
-static shared_ptr<BoolType> SHARED_BOOLEAN = make_shared<BoolType>();
+// Types are keyed by their kind followed by the words describing them, such as the ids of their parameter types.
+// Checking modules in parallel creates types from several threads, so the table is guarded by a mutex.
+namespace {
+struct KeyHash {
+  size_t operator()(const vector<uint32_t> &key) const {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t word : key) {
+      hash = (hash ^ word) * 1099511628211ull;
+    }
+
+    return hash;
+  }
+};
+
+struct TypeTable {
+  std::mutex mutex;
+  unordered_map<vector<uint32_t>, TypeId, KeyHash> ids;
+  vector<shared_ptr<Type>> types; // the type interned under each id, at id - 1
+};
+
+TypeTable &type_table() {
+  static TypeTable table;
+  return table;
+}
+
+template <typename T> shared_ptr<T> interned(shared_ptr<T> type, const vector<uint32_t> &key) {
+  TypeTable &table = type_table();
+  std::lock_guard lock(table.mutex);
+  auto [it, inserted] = table.ids.try_emplace(key, (TypeId)table.ids.size() + 1);
+  if (!inserted) {
+    // The key starts with the kind, so the type already interned under it is a T as well
+    return std::static_pointer_cast<T>(table.types[it->second - 1]);
+  }
+
+  type->id = it->second;
+  table.types.push_back(type);
+  return type;
+}
+}; // namespace
+
+static shared_ptr<VoidType> SHARED_VOID = interned(make_shared<VoidType>(), {VOID});
+static shared_ptr<StringType> SHARED_STRING = interned(make_shared<StringType>(), {STRING});
+static shared_ptr<NumberType> SHARED_NUMBER = interned(make_shared<NumberType>(), {NUMBER});
+static shared_ptr<BoolType> SHARED_BOOLEAN = interned(make_shared<BoolType>(), {BOOL});
 
 shared_ptr<analysis::VoidType> analysis::MK_VOID() {
   return SHARED_VOID;
@@ -25,24 +69,63 @@ shared_ptr<analysis::NumberType> analysis::MK_NUM() {
 }
 
 shared_ptr<analysis::PointerType> analysis::MK_PTR(shared_ptr<Type> u) {
-  return make_shared<PointerType>(u);
+  return interned(make_shared<PointerType>(u), {POINTER, u->id});
 }
 
-shared_ptr<analysis::StructType> analysis::MK_STRUCT(string name) {
-  return make_shared<StructType>(name);
+// Appends a member table to a struct key, ordered by member name so the key doesn't depend on hash map order.
+template <typename T>
+static void key_members(vector<uint32_t> &key, const unordered_map<utils::SymbolId, shared_ptr<T>> &members) {
+  vector<pair<utils::SymbolId, TypeId>> sorted;
+  for (const auto &[name, type] : members) {
+    sorted.emplace_back(name, type->id);
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  key.push_back((uint32_t)sorted.size());
+  for (const auto &[name, id] : sorted) {
+    key.push_back(name);
+    key.push_back(id);
+  }
 }
 
-shared_ptr<analysis::FnType> analysis::MK_FN(vector<FnParam> params, shared_ptr<Type> returns, bool variadic,
-                                             shared_ptr<ast::BlockStmt> body) {
-  return make_shared<FnType>(params, returns, variadic, body);
+shared_ptr<analysis::StructType> analysis::MK_STRUCT(shared_ptr<StructType> layout) {
+  vector<uint32_t> key = {STRUCT, utils::intern(layout->module), utils::intern(layout->name)};
+  key.push_back((uint32_t)layout->publicMembers.size());
+  key.insert(key.end(), layout->publicMembers.begin(), layout->publicMembers.end());
+  key_members(key, layout->staticProperties);
+  key_members(key, layout->staticMethods);
+  key_members(key, layout->properties);
+  key_members(key, layout->methods);
+  return interned(layout, key);
 }
 
-bool analysis::types_match(shared_ptr<Type> expected, shared_ptr<Type> recieved) {
-  if (expected->kind != recieved->kind) {
-    return false;
+shared_ptr<analysis::FnType> analysis::MK_FN(vector<FnParam> params, shared_ptr<Type> returns, bool variadic) {
+  vector<uint32_t> key = {FN, variadic, returns->id};
+  // Param names are part of the signature too, the body of a fn refers to its params by them
+  for (const auto &param : params) {
+    key.push_back(param.name);
+    key.push_back(param.type->id);
   }
 
-  return expected->str() == recieved->str(); // TODO: Make lose comparison
+  return interned(make_shared<FnType>(params, returns, variadic), key);
+}
+
+// Members follow from the summary, so its hash stands in for them.
+shared_ptr<analysis::ModuleType> analysis::MK_MODULE(shared_ptr<ModuleType> layout) {
+  uint32_t low = (uint32_t)layout->exported, high = (uint32_t)(layout->exported >> 32);
+  return interned(layout, {MODULE, utils::intern(layout->name), low, high});
+}
+
+shared_ptr<analysis::Type> analysis::type_of(TypeId id) {
+  TypeTable &table = type_table();
+  std::lock_guard lock(table.mutex);
+  return id > 0 && id <= table.types.size() ? table.types[id - 1] : nullptr;
+}
+
+size_t analysis::interned_type_count() {
+  TypeTable &table = type_table();
+  std::lock_guard lock(table.mutex);
+  return table.ids.size();
 }
 
 analysis::VoidType *analysis::AS_VOID(shared_ptr<Type> t) {
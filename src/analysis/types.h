@@ -2,10 +2,6 @@
 
 #include "../bedrock.h"
 
-namespace ast {
-struct BlockStmt;
-};
-
 namespace analysis {
 enum TypeKind {
   NUMBER,
@@ -21,9 +17,15 @@ enum TypeKind {
   GENERIC_STRUCT,
 };
 
+/// @brief Canonical identity of a type. Types which are structurally the same share an id, so comparing two types is
+/// comparing their ids. Handed out by the MK_ functions below, 0 is never a valid id.
+typedef uint32_t TypeId;
+
 struct Type {
   TypeKind kind;
+  TypeId id = 0;
 
+  // Only used for diagnostics and debug output, see types_match for comparing types.
   virtual string str() = 0;
 };
 
@@ -88,10 +90,13 @@ struct VoidType : public Type {
 
 struct ModuleType : public Type {
   string name;
+  uint64_t exported = 0; // exported_hash of the summary the members were taken from, 0 when there was none
+  unordered_map<utils::SymbolId, shared_ptr<Type>> symbols; // exported symbols of the module, see analysis::Interface
+  unordered_map<utils::SymbolId, shared_ptr<Type>> types;   // exported types of the module
 
   virtual ~ModuleType() {
   }
-  ModuleType() {
+  ModuleType(string name) : name(name) {
     kind = MODULE;
   }
   string str() override {
@@ -100,10 +105,10 @@ struct ModuleType : public Type {
 };
 
 struct FnParam {
-  string name;
+  utils::SymbolId name;
   shared_ptr<Type> type;
 
-  FnParam(string n, shared_ptr<Type> t) {
+  FnParam(utils::SymbolId n, shared_ptr<Type> t) {
     name = n;
     type = t;
   }
@@ -113,15 +118,14 @@ struct FnType : public Type {
   vector<FnParam> params;
   shared_ptr<Type> returns;
   bool variadic;
-  shared_ptr<ast::BlockStmt> body;
 
   virtual ~FnType() {
   }
   FnType() {
     kind = FN;
   }
-  FnType(vector<FnParam> params, shared_ptr<Type> returns, bool variadic, shared_ptr<ast::BlockStmt> body)
-      : params(params), returns(returns), variadic(variadic), body(body) {
+  FnType(vector<FnParam> params, shared_ptr<Type> returns, bool variadic)
+      : params(params), returns(returns), variadic(variadic) {
     kind = FN;
   }
 
@@ -138,25 +142,26 @@ struct FnType : public Type {
 };
 
 struct StructType : public Type {
+  string module; // name of the declaring scope, so same-named structs of different modules stay apart
   string name;
-  set<string> publicMembers; // whether a member is public or private
-  unordered_map<string, shared_ptr<Type>> staticProperties;
-  unordered_map<string, shared_ptr<FnType>> staticMethods;
-  unordered_map<string, shared_ptr<Type>> properties;
-  unordered_map<string, shared_ptr<FnType>> methods;
+  set<utils::SymbolId> publicMembers; // whether a member is public or private
+  unordered_map<utils::SymbolId, shared_ptr<Type>> staticProperties;
+  unordered_map<utils::SymbolId, shared_ptr<FnType>> staticMethods;
+  unordered_map<utils::SymbolId, shared_ptr<Type>> properties;
+  unordered_map<utils::SymbolId, shared_ptr<FnType>> methods;
 
   virtual ~StructType() {
   }
-  StructType(string name) : name(name) {
+  StructType(string module, string name) : module(module), name(name) {
     kind = STRUCT;
   }
 
-  bool hasField(string propName) {
+  bool hasField(utils::SymbolId propName) {
     return hasProperty(propName, false) || hasProperty(propName, true) || hasMethod(propName, false) ||
            hasMethod(propName, true);
   }
 
-  bool hasProperty(string propName, bool isStatic) {
+  bool hasProperty(utils::SymbolId propName, bool isStatic) {
     if (isStatic) {
       return staticProperties.find(propName) != staticProperties.end();
     }
@@ -164,7 +169,7 @@ struct StructType : public Type {
     return properties.find(propName) != properties.end();
   }
 
-  bool hasMethod(string propName, bool isStatic) {
+  bool hasMethod(utils::SymbolId propName, bool isStatic) {
     if (isStatic) {
       return staticMethods.find(propName) != staticMethods.end();
     }
@@ -172,7 +177,7 @@ struct StructType : public Type {
     return methods.find(propName) != methods.end();
   }
 
-  shared_ptr<Type> getProperty(string propName, bool isStatic) {
+  shared_ptr<Type> getProperty(utils::SymbolId propName, bool isStatic) {
     if (isStatic) {
       return staticProperties[propName];
     }
@@ -180,7 +185,7 @@ struct StructType : public Type {
     return properties[propName];
   }
 
-  shared_ptr<FnType> getMethod(string propName, bool isStatic) {
+  shared_ptr<FnType> getMethod(utils::SymbolId propName, bool isStatic) {
     if (isStatic) {
       return staticMethods[propName];
     }
@@ -204,13 +209,13 @@ struct StructType : public Type {
     if (this->staticProperties.size() > 0 || this->properties.size() > 0) {
       out += yellow("  properties") + ":\n";
       for (const auto &[name, type] : this->staticProperties) {
-        out += "    " + red(name) + ":";
-        out += space((uint)(PADDING - name.size()));
+        out += "    " + red(utils::symbol_name(name)) + ":";
+        out += space((uint)(PADDING - utils::symbol_str(name).size()));
         out += type->str() += "\n";
       }
 
       for (const auto &[name, type] : this->properties) {
-        out += "    " + white(name) + ":" + space((uint)(PADDING - name.size()));
+        out += "    " + white(utils::symbol_name(name)) + ":" + space((uint)(PADDING - utils::symbol_str(name).size()));
         out += type->str() += "\n";
       }
     }
@@ -219,13 +224,13 @@ struct StructType : public Type {
     if (this->staticMethods.size() > 0 || this->methods.size() > 0) {
       out += yellow("  methods") + ":\n";
       for (const auto &[name, type] : this->staticMethods) {
-        out += "    " + red(name) + ":";
-        out += space((uint)(PADDING - name.size()));
+        out += "    " + red(utils::symbol_name(name)) + ":";
+        out += space((uint)(PADDING - utils::symbol_str(name).size()));
         out += type->str() += "\n";
       }
 
       for (const auto &[name, type] : this->methods) {
-        out += "    " + white(name) + ":" + space((uint)(PADDING - name.size()));
+        out += "    " + white(utils::symbol_name(name)) + ":" + space((uint)(PADDING - utils::symbol_str(name).size()));
         out += type->str() += "\n";
       }
     }
@@ -234,14 +239,25 @@ struct StructType : public Type {
   }
 };
 // Type Creation
+// Every type is created through these so it gets its TypeId, and types built from the same parts are the same object.
+// Modules are identified by name and the summary they were filled from, structs by their declaring module, name and
+// members, and every other type by its kind and the ids of the types it is built from. Modules and structs are built in
+// full before they are interned, so an interned type never changes.
 
 shared_ptr<analysis::VoidType> MK_VOID();
 shared_ptr<analysis::BoolType> MK_BOOL();
 shared_ptr<analysis::StringType> MK_STR();
 shared_ptr<analysis::PointerType> MK_PTR(shared_ptr<Type>);
 shared_ptr<analysis::NumberType> MK_NUM();
-shared_ptr<analysis::StructType> MK_STRUCT(string);
-shared_ptr<analysis::FnType> MK_FN(vector<FnParam>, shared_ptr<Type>, bool, shared_ptr<ast::BlockStmt>);
+shared_ptr<analysis::StructType> MK_STRUCT(shared_ptr<StructType>);
+shared_ptr<analysis::FnType> MK_FN(vector<FnParam>, shared_ptr<Type>, bool);
+shared_ptr<analysis::ModuleType> MK_MODULE(shared_ptr<ModuleType>);
+
+/// @brief Returns the type interned under id, or nullptr for 0 and ids never handed out.
+shared_ptr<Type> type_of(TypeId id);
+
+/// @brief Number of distinct types interned so far.
+size_t interned_type_count();
 
 analysis::VoidType *AS_VOID(shared_ptr<Type>);
 analysis::BoolType *AS_BOOL(shared_ptr<Type>);
@@ -251,5 +267,7 @@ analysis::NumberType *AS_NUM(shared_ptr<Type>);
 analysis::StructType *AS_STRUCT(shared_ptr<Type>);
 analysis::FnType *AS_FN(shared_ptr<Type>);
 
-bool types_match(shared_ptr<Type> expected, shared_ptr<Type> recieved);
+inline bool types_match(const shared_ptr<Type> &expected, const shared_ptr<Type> &recieved) {
+  return expected->id == recieved->id;
+}
 }; // namespace analysis
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "arena.h"
+
+#include <algorithm>
+
+ast::AstArena::~AstArena() {
+  // Parents are created after their children, so destroying in reverse keeps the usual teardown order.
+  for (auto it = destructors.rbegin(); it != destructors.rend(); it++) {
+    it->destroy(it->node);
+  }
+}
+
+void *ast::AstArena::allocate(size_t size, size_t align) {
+  size_t start = (block_used + align - 1) & ~(align - 1);
+
+  if (blocks.empty() || start + size > block_capacity) {
+    size_t capacity = std::max(BLOCK_SIZE, size + align);
+    blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(capacity));
+    block_capacity = capacity;
+    start = 0;
+  }
+
+  // operator new[] returns memory aligned for any fundamental type, so offset 0 of a fresh block is always aligned.
+  block_used = start + size;
+  used += size;
+  return blocks.back().get() + start;
+}
+
+size_t ast::AstArena::bytes_used() const {
+  return used;
+}
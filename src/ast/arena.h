@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ast {
+/// @brief Bump allocator owning every node of a single module. Nodes are carved out of large blocks and linked by raw
+/// pointers, so building a tree costs a pointer bump per node instead of a malloc and a reference count. Nothing is
+/// freed on its own, destroying the arena runs the destructor of every node and releases all blocks at once.
+struct AstArena {
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  AstArena() = default;
+  AstArena(const AstArena &) = delete;
+  AstArena &operator=(const AstArena &) = delete;
+  ~AstArena();
+
+  /// @brief Constructs a T inside the arena. The node lives exactly as long as the arena.
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors.push_back({node, [](void *p) { static_cast<T *>(p)->~T(); }});
+    }
+
+    return node;
+  }
+
+  /// @brief Returns size bytes aligned to align. Requests larger than a block get a block of their own.
+  void *allocate(size_t size, size_t align);
+  /// @brief Total bytes handed out by allocate.
+  size_t bytes_used() const;
+
+private:
+  struct Destructor {
+    void *node;
+    void (*destroy)(void *);
+  };
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks;
+  size_t block_used = 0;
+  size_t block_capacity = 0;
+  size_t used = 0;
+  std::vector<Destructor> destructors;
+};
+}; // namespace ast
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../analysis/types.h"
 #include "../bedrock.h"
 #include "../util/utils.h"
 
@@ -12,7 +13,7 @@ enum NodeKind {
   VAR_DECL_STMT,
   FN_DECL_STMT,
   RETURN_STMT,
-  // IMPORT_STMT,
+  IMPORT_STMT,
   STRUCT_STMT,
   // UNSAFE_STMT,
   // WHILE_STMT,
@@ -49,34 +50,41 @@ enum NodeKind {
   NUM_MACRO,
 };
 
+class Dumper; // forward declare dumper. See dump.h
+
+// Every node records the type analysis gave it in type_id, so later passes look it up with analysis::type_of instead
+// of checking the node again. It stays 0 until the node is checked.
+
 struct Expr {
   NodeKind kind;
-  virtual std::string debug(size_t depth) = 0;
+  analysis::TypeId type_id = 0;
+  virtual void dump(Dumper &out) = 0;
 };
 
 struct Stmt {
   NodeKind kind;
-  virtual std::string debug(size_t depth) = 0;
+  analysis::TypeId type_id = 0;
+  virtual void dump(Dumper &out) = 0;
 };
 
 struct Type {
   NodeKind kind;
-  virtual std::string debug(size_t depth) = 0;
+  analysis::TypeId type_id = 0;
+  virtual void dump(Dumper &out) = 0;
 };
 
 struct PropertyKey {
-  bool is_pub;    // used for structs only.
-  bool is_static; // used for structs only.
-  bool variadic;  // Only used on function declarations and fn_types
-  string name;
-  shared_ptr<Type> type;
+  bool is_pub = false;    // used for structs only.
+  bool is_static = false; // used for structs only.
+  bool variadic = false;  // Only used on function declarations and fn_types
+  utils::SymbolId name;
+  Type *type = nullptr;
 
   PropertyKey() {
   }
-  PropertyKey(string name, shared_ptr<Type> type) : name(name), type(type) {
+  PropertyKey(utils::SymbolId name, Type *type) : name(name), type(type) {
   }
-  PropertyKey(bool pub, bool s, string name, shared_ptr<Type> type)
-      : is_pub(pub), is_static(s), name(name), type(type) {
+  PropertyKey(bool pub, bool s, utils::SymbolId name, Type *type) : is_pub(pub), is_static(s), name(name), type(type) {
   }
 };
 
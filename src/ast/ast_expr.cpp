@@ -1,89 +1,59 @@
 #include "ast_expr.h"
 
+#include "dump.h"
+
 using namespace ast;
-using std::to_string;
-using utils::space;
 
 //  NumberExpr
-string NumberExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += blue("Number") + "(" + yellow(this->value) + ")\n";
-
-  return str;
+void NumberExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.field("value", value);
+  out.close();
 }
 
 //  StringExpr
-string StringExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += bold_blue("String") + "(\"" + yellow(this->value) + "\")\n";
-
-  return str;
+void StringExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.field("value", value);
+  out.close();
 }
 
 //  SymbolExpr
-string SymbolExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += bold_blue("Symbol") + "(" + this->symbol + ")\n";
-
-  return str;
+void SymbolExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.field("symbol", utils::symbol_name(symbol));
+  out.close();
 }
 
 //  BinaryExpr
-string BinaryExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += bold_blue("Binary ") + this->operation.value + "\n";
-
-  str += space(depth + 1);
-  str += magenta("Left") + ":\n" + this->left->debug(depth + 2);
-  str += space(depth + 1);
-  str += magenta("Right") + ":\n" + this->right->debug(depth + 2);
-
-  return str;
+void BinaryExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.field("operator", lexer::token_text(operation.kind));
+  out.child("left", left);
+  out.child("right", right);
+  out.close();
 }
 
 //  PrefixExpr
-string PrefixExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += bold_blue("Prefix ") + this->operation.value + "\n";
-  str += space(depth + 1);
-  str += magenta("Right") + ":\n" + this->right->debug(depth + 2);
-
-  return str;
+void PrefixExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.field("operator", lexer::token_text(operation.kind));
+  out.child("right", right);
+  out.close();
 }
 
 //  AssignmentExpr
-string AssignmentExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += bold_blue("AssignmentExpr") + "\n";
-
-  str += space(depth + 1);
-  str += magenta("Assigne") + ":\n" + this->assigne->debug(depth + 2);
-
-  str += space(depth + 1);
-  str += magenta("Value") + ":\n" + this->value->debug(depth + 2);
-
-  return str;
+void AssignmentExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.child("assigne", assigne);
+  out.child("value", value);
+  out.close();
 }
 
-string CallExpr::debug(size_t depth) {
-  string str = space(depth);
-  str += blue("CallExpr") + "\n";
-
-  str += space(depth + 1);
-  str += magenta("Calle") + ":\n" + calle->debug(depth + 2);
-
-  if (args.size() > 0) {
-    str += space(depth + 1);
-    str += magenta("Args") + ":\n";
-
-    for (const auto &arg : args) {
-      str += arg->debug(depth + 2);
-    }
-
-    str += "\n";
-  } else {
-    str += space(depth + 1) + magenta("Args") + ": none\n";
-  }
-
-  return str;
-}
\ No newline at end of file
+//  CallExpr
+void CallExpr::dump(Dumper &out) {
+  out.open(kind);
+  out.child("calle", calle);
+  out.children("args", args);
+  out.close();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../analysis/scope.h"
 #include "../lexing/token.h"
 #include "ast.h"
 
@@ -12,7 +13,7 @@ struct NumberExpr : public Expr {
   NumberExpr() {
     kind = NUMBER_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct StringExpr : public Expr {
@@ -23,38 +24,51 @@ struct StringExpr : public Expr {
   StringExpr() {
     kind = STRING_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct SymbolExpr : public Expr {
-  string symbol;
+  utils::SymbolId symbol;
+  analysis::Binding binding; // set by analysis
 
   virtual ~SymbolExpr() {
   }
   SymbolExpr() {
     kind = SYMBOL_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 // Complex Binary/Unary
 
+/// @brief The operator of a binary or prefix expression. Operators have a fixed spelling (see lexer::token_text), so
+/// only the kind and where it appeared in the module's source are kept.
+struct Operation {
+  lexer::TokenKind kind;
+  uint32_t offset;
+
+  Operation() {
+  }
+  Operation(const lexer::Token &tk) : kind(tk.kind), offset(tk.offset) {
+  }
+};
+
 struct BinaryExpr : public Expr {
-  shared_ptr<Expr> left;
-  shared_ptr<Expr> right;
-  lexer::Token operation;
+  Expr *left = nullptr;
+  Expr *right = nullptr;
+  Operation operation;
 
   virtual ~BinaryExpr() {
   }
   BinaryExpr() {
     kind = BINARY_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct PrefixExpr : public Expr {
-  shared_ptr<Expr> right;
-  lexer::Token operation;
+  Expr *right = nullptr;
+  Operation operation;
 
   virtual ~PrefixExpr() {
   }
@@ -62,31 +76,31 @@ struct PrefixExpr : public Expr {
     kind = PREFIX_EXPR;
   }
 
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct AssignmentExpr : public Expr {
-  shared_ptr<Expr> assigne;
-  shared_ptr<Expr> value;
+  Expr *assigne = nullptr;
+  Expr *value = nullptr;
 
   virtual ~AssignmentExpr() {
   }
   AssignmentExpr() {
     kind = ASSIGN_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct CallExpr : public Expr {
-  shared_ptr<Expr> calle;
-  vector<shared_ptr<Expr>> args;
+  Expr *calle = nullptr;
+  vector<Expr *> args;
 
   virtual ~CallExpr() {
   }
   CallExpr() {
     kind = CALL_EXPR;
   }
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 }; // namespace ast
\ No newline at end of file
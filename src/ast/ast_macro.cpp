@@ -1,40 +1,30 @@
 #include "ast_macro.h"
 
+#include "dump.h"
+
 using namespace ast;
-using std::to_string;
-using utils::space;
 
-string StrMacro::debug(size_t depth) {
-  string str = space(depth);
-  str += red("@Str") + "\n";
-  str += expr->debug(depth + 1);
-  return str;
+void StrMacro::dump(Dumper &out) {
+  out.open(kind);
+  out.child("expr", expr);
+  out.close();
 }
 
-string NumMacro::debug(size_t depth) {
-  string str = space(depth);
-  str += red("@Num") + "\n";
-  str += expr->debug(depth + 1);
-  return str;
+void NumMacro::dump(Dumper &out) {
+  out.open(kind);
+  out.child("expr", expr);
+  out.close();
 }
 
-string FmtMacro::debug(size_t depth) {
-  string str = space(depth);
-  str += red("@Fmt") + "\n";
-  str += space(depth + 1) + magenta("FormatString") + ": " + formatString + "\n";
-  str += space(depth + 1) + magenta("Args") + ":\n";
-
-  for (const auto &arg : args) {
-    str += arg->debug(depth + 2);
-  }
-
-  str += "\n";
-  return str;
+void FmtMacro::dump(Dumper &out) {
+  out.open(kind);
+  out.field("format", formatString);
+  out.children("args", args);
+  out.close();
 }
 
-string LogMacro::debug(size_t depth) {
-  string str = space(depth);
-  str += red("@Log") + "\n";
-  str += expr->debug(depth + 1);
-  return str;
-}
\ No newline at end of file
+void LogMacro::dump(Dumper &out) {
+  out.open(kind);
+  out.child("expr", expr);
+  out.close();
+}
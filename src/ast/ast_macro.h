@@ -5,7 +5,7 @@
 
 namespace ast {
 struct StrMacro : public Expr {
-  shared_ptr<Expr> expr;
+  Expr *expr = nullptr;
 
   virtual ~StrMacro() {
   }
@@ -13,11 +13,11 @@ struct StrMacro : public Expr {
     kind = STR_MACRO;
   }
 
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct LogMacro : public Expr {
-  shared_ptr<Expr> expr;
+  Expr *expr = nullptr;
 
   virtual ~LogMacro() {
   }
@@ -25,12 +25,12 @@ struct LogMacro : public Expr {
     kind = LOG_MACRO;
   }
 
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct FmtMacro : public Expr {
   string formatString;
-  vector<shared_ptr<Expr>> args;
+  vector<Expr *> args;
 
   virtual ~FmtMacro() {
   }
@@ -38,11 +38,11 @@ struct FmtMacro : public Expr {
     kind = FMT_MACRO;
   }
 
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct NumMacro : public Expr {
-  shared_ptr<Expr> expr;
+  Expr *expr = nullptr;
 
   virtual ~NumMacro() {
   }
@@ -50,7 +50,7 @@ struct NumMacro : public Expr {
     kind = NUM_MACRO;
   }
 
-  string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 }; // namespace ast
\ No newline at end of file
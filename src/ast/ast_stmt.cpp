@@ -1,156 +1,112 @@
 #include "ast_stmt.h"
 
 #include "ast_type.h"
+#include "cache.h"
+#include "dump.h"
 
 using namespace ast;
-using utils::space;
 
 // ModuleStmt
-string ModuleStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("Module") + "(" + name + ")\n";
-
-  for (const auto &stmt : body) {
-    output += stmt->debug(depth + 2) + "\n";
-  }
-
-  return output;
+void ModuleStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.field("name", name);
+  out.children("body", body);
+  out.close();
 }
 
 // ProgramStmt
-string ProgramStmt::debug(size_t depth) {
-  string output = bold_white("Program\n");
-
-  for (const auto &mod : modules) {
-    output += mod->debug(depth) + "\n";
-  }
+void ProgramStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.children("modules", modules);
+  out.close();
+}
 
-  return output;
+// ImportStmt
+void ImportStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.field("path", path);
+  out.field("alias", utils::symbol_name(alias));
+  out.close();
 }
 
 // BlockStmt
-string BlockStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("Block\n");
-
-  for (const auto &stmt : body) {
-    output += stmt->debug(depth + 2) + "\n";
-  }
-
-  return output;
+void BlockStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.children("body", body);
+  out.close();
 }
 
 // StructStmt
-
-string displayProperty(size_t depth, ast::PropertyKey prop) {
-  string out = space(depth) + bold_green(prop.name) + ": \n";
-
-  out += space(depth + 1) + blue("Public") + ": ";
-  out += string((prop.is_pub || prop.is_static) ? "true" : "false") + "\n";
-
-  out += space(depth + 1);
-  out += blue("Static") + ": " + string(prop.is_static ? "true" : "false");
-
-  out += "\n" + prop.type->debug(depth + 1);
-  return out;
-}
-
-string StructStmt::debug(size_t depth) {
-  string out = space(depth) + bold_magenta("Struct");
-  out += "." + this->name;
-
-  if (this->generics.size() > 0) {
-    out += " <";
-
-    for (size_t i = 0; i < this->generics.size(); i++) {
-      out += this->generics.at(i);
-
-      if (i < this->generics.size() - 1) {
-        out += ", ";
-      }
-    }
-
-    out += ">";
+void StructStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.field("name", utils::symbol_name(name));
+
+  out.key("generics");
+  out.open_list();
+  for (auto generic : generics) {
+    out.write_text(utils::symbol_name(generic));
   }
 
-  out += "\n" + space(depth + 1) + blue("Pub") + ": ";
-  out += yellow(string(this->pub ? "true" : "false")) + "\n";
-
-  if (this->properties.size() > 0) {
-    out += space(depth + 1) + blue("Properties") + ": \n";
-
-    for (const auto &property : properties) {
-      out += displayProperty(depth + 2, property);
-    }
-
-    out += "\n";
-  }
-
-  return out;
+  out.close_list();
+  out.flag("pub", pub);
+  dump_properties(out, "properties", properties);
+  out.close();
 }
 
 // FnDeclStmt
-string FnDeclStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("FnDecl") + "\n";
-  output += space(depth + 1) + blue("Name") + ": " + this->name + "\n";
-  output += space(depth + 1) + blue("Variadic") + ": ";
-  output += string(this->variadic ? "true" : "false") + "\n";
-
-  if (return_type) {
-    output += space(depth + 1) + blue("Returns") + ": \n";
-    output += return_type->debug(depth + 2);
+void FnDeclStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.field("name", utils::symbol_name(name));
+  out.flag("variadic", variadic);
+  dump_properties(out, "params", params);
+  out.child("returns", return_type);
+
+  // A cached body is the tree the parser produced, so it is shown like one. Lazily parsed bodies are left alone.
+  if (!body && body_cached) {
+    load_cached_body(this);
   }
 
-  output += body->debug(depth + 1);
-  return output;
-}
-
-// VarDeclStmt
-string VarDeclStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("VarDecl") + "\n";
-  output += space(depth + 1) + blue("Varname") + ": " + this->varname + "\n";
-  output += space(depth + 1) + blue("Constant") + ": ";
-  output += string(this->constant ? "true" : "false") + "\n";
-
-  if (type) {
-    output += space(depth + 1) + blue("Type") + ":\n";
-    output += type->debug(depth + 2);
+  if (!body && body_end > body_start) {
+    out.field("body", "(not parsed)");
+  } else {
+    out.child("body", body);
   }
 
-  if (value) {
-    output += space(depth + 1) + blue("Value") + ":\n";
-    output += value->debug(depth + 2);
-  }
+  out.close();
+}
 
-  return output;
+// VarDeclStmt
+void VarDeclStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.field("varname", utils::symbol_name(varname));
+  out.flag("constant", constant);
+  out.child("type", type);
+  out.child("value", value);
+  out.close();
 }
 
 // DeferStmt
-string DeferStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("Defer") + "\n";
-
-  for (const auto &action : actions) {
-    output += action->debug(depth + 1) + "\n";
-  }
-
-  return output;
+void DeferStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.children("actions", actions);
+  out.close();
 }
 
 // ImplStmt
-string ImplStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("Impl") + type->debug(0) + "\n";
-  return output;
+void ImplStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.child("type", type);
+  out.close();
 }
 
 // ExprStmt
-string ExprStmt::debug(size_t depth) {
-  return expr->debug(depth);
+void ExprStmt::dump(Dumper &out) {
+  expr->dump(out);
 }
 
-string ReturnStmt::debug(size_t depth) {
-  string output = space(depth) + bold_magenta("Return") + "\n";
-
-  if (rhs) {
-    output += rhs->debug(depth + 1) + "\n";
-  }
-
-  return output;
-}
\ No newline at end of file
+// ReturnStmt
+void ReturnStmt::dump(Dumper &out) {
+  out.open(kind);
+  out.child("value", rhs);
+  out.close();
+}
@@ -2,136 +2,168 @@
 
 #include "../analysis/scope.h"
 #include "../lexing/token.h"
+#include "arena.h"
 #include "ast.h"
 
 namespace ast {
+struct Snapshot;
+
 struct ModuleStmt : public Stmt {
-  bool is_entry;
+  bool is_entry = false;
   shared_ptr<analysis::Scope> scope;
+  shared_ptr<lexer::SourceFile> file; // keeps the source alive for tokens stored inside the tree
   string name;
-  vector<shared_ptr<Stmt>> body;
+  AstArena arena; // owns every node below this module
+  shared_ptr<Snapshot> snapshot; // set when the module was loaded from the AST cache
+  vector<Stmt *> body;
 
   virtual ~ModuleStmt() {
   }
   ModuleStmt() {
     kind = MODULE_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
+};
+
+struct ImportStmt : public Stmt {
+  string path;           // resolved path of the imported file, which is also the name of its module
+  utils::SymbolId alias; // name the module is bound to inside the importing module
+
+  virtual ~ImportStmt() {
+  }
+  ImportStmt() {
+    kind = IMPORT_STMT;
+  }
+  void dump(Dumper &out);
 };
 
 struct ProgramStmt : public Stmt {
   shared_ptr<ModuleStmt> entry;
   vector<shared_ptr<ModuleStmt>> modules;
+  unordered_map<string, shared_ptr<analysis::Interface>> summaries; // imports left unbuilt, see parser::parse
 
   virtual ~ProgramStmt() {
   }
   ProgramStmt() {
     kind = PROGRAM_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct BlockStmt : public Stmt {
   shared_ptr<analysis::Scope> scope;
-  vector<shared_ptr<Stmt>> body;
+  vector<Stmt *> body;
 
   virtual ~BlockStmt() {
   }
   BlockStmt() {
     kind = BLOCK_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct ExprStmt : public Stmt {
-  shared_ptr<Expr> expr;
+  Expr *expr = nullptr;
 
   virtual ~ExprStmt() {
   }
   ExprStmt() {
     kind = EXPR_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct VarDeclStmt : public Stmt {
-  bool constant;
-  string varname;
-  shared_ptr<Type> type;
-  shared_ptr<Expr> value;
+  bool constant = false;
+  utils::SymbolId varname;
+  uint32_t slot = 0; // set by analysis, see analysis::Binding
+  Type *type = nullptr;
+  Expr *value = nullptr;
 
   virtual ~VarDeclStmt() {
   }
   VarDeclStmt() {
     kind = VAR_DECL_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct FnDeclStmt : public Stmt {
-  bool variadic; // whether the function has variable arity -> ...name: []T
-  string name;
+  bool variadic = false; // whether the function has variable arity -> ...name: []T
+  utils::SymbolId name;
   vector<PropertyKey> params;
-  shared_ptr<Type> return_type;
-  shared_ptr<BlockStmt> body;
+  Type *return_type = nullptr;
+  BlockStmt *body = nullptr; // stays nullptr for a lazy or cached body until parser::fn_body builds it
+
+  // Set when the body was skipped. [body_start, body_end) is the byte range of the body including its braces, or of
+  // its encoding inside module->snapshot when body_cached is set.
+  ModuleStmt *module = nullptr;
+  uint32_t body_start = 0;
+  uint32_t body_end = 0;
+  bool body_cached = false;
+
+  // Byte range of the body in the module's source, from its opening brace up to the token after it. Analysis
+  // fingerprints it to tell whether the body changed since it was last checked. See analysis::QueryTable.
+  uint32_t source_start = 0;
+  uint32_t source_end = 0;
 
   virtual ~FnDeclStmt() {
   }
   FnDeclStmt() {
     kind = FN_DECL_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 // Forward declare FnType
 struct FnType;
 
 struct StructStmt : public Stmt {
-  string name;
-  vector<string> generics;
+  utils::SymbolId name;
+  vector<utils::SymbolId> generics;
   vector<PropertyKey> properties;
-  bool pub;
-  unordered_map<string, bool> public_status; // map of all keys and whether it's public.
+  bool pub = false;
+  unordered_map<utils::SymbolId, bool> public_status; // map of all keys and whether it's public.
 
   virtual ~StructStmt() {
   }
   StructStmt() {
     kind = STRUCT_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct ImplStmt : public Stmt {
-  shared_ptr<Type> type;
+  Type *type = nullptr;
 
   virtual ~ImplStmt() {
   }
   ImplStmt() {
     kind = IMPL_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct DeferStmt : public Stmt {
-  vector<shared_ptr<Expr>> actions;
+  vector<Expr *> actions;
 
   virtual ~DeferStmt() {
   }
   DeferStmt() {
     kind = DEFER_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 struct ReturnStmt : public Stmt {
-  shared_ptr<Expr> rhs;
+  Expr *rhs = nullptr;
 
   virtual ~ReturnStmt() {
   }
   ReturnStmt() {
     kind = RETURN_STMT;
   }
-  std::string debug(size_t depth);
+  void dump(Dumper &out);
 };
 
 }; // namespace ast
\ No newline at end of file
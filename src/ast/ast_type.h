@@ -13,48 +13,47 @@ using std::vector;
 namespace ast {
 
 struct SymbolType : public Type {
-  string symbol;
+  utils::SymbolId symbol;
 
   virtual ~SymbolType() {
   }
   SymbolType() {
     kind = SYMBOL_TYPE;
   }
-  SymbolType(string symbol) : symbol(symbol) {
+  SymbolType(utils::SymbolId symbol) : symbol(symbol) {
     kind = SYMBOL_TYPE;
   }
-  virtual std::string debug(size_t depth);
+  virtual void dump(Dumper &out);
 };
 
 struct PointerType : public Type {
-  shared_ptr<Type> type;
+  Type *type = nullptr;
 
   virtual ~PointerType() {
   }
   PointerType() {
     kind = POINTER_TYPE;
   }
-  virtual std::string debug(size_t depth);
+  virtual void dump(Dumper &out);
 };
 
 struct FnType : public Type {
-  bool variadic; // whether the function has variable arity -> ...name: []T
-  vector<shared_ptr<Type>> generics;
+  bool variadic = false; // whether the function has variable arity -> ...name: []T
+  vector<Type *> generics;
   vector<PropertyKey> params;
-  shared_ptr<Type> returns;
+  Type *returns = nullptr;
 
   virtual ~FnType() {
   }
   FnType() {
     kind = FN_TYPE;
-    returns = make_shared<SymbolType>("void"); // set default return
   }
-  FnType(vector<shared_ptr<Type>> generics, vector<PropertyKey> params, shared_ptr<Type> returns)
-      : generics(std::move(generics)), params(std::move(params)), returns(std::move(returns)) {
+  FnType(vector<Type *> generics, vector<PropertyKey> params, Type *returns)
+      : generics(std::move(generics)), params(std::move(params)), returns(returns) {
     kind = FN_TYPE;
   }
 
-  virtual std::string debug(size_t depth);
+  virtual void dump(Dumper &out);
 };
 
 }; // namespace ast
@@ -0,0 +1,719 @@
+#include "cache.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "../util/files.h"
+#include "ast_expr.h"
+#include "ast_macro.h"
+#include "ast_type.h"
+
+using namespace ast;
+
+// Layout of a snapshot:
+//   magic[8] format:u32 hash:u64
+//   symbol count:u32, then every name as len:u32 bytes. Index 0 is reserved for the empty symbol.
+//   statement count:u32, then every top level statement.
+// Nodes are a kind:u8 followed by their fields in declaration order. Child nodes are written inline, a missing child is
+// NULL_NODE. Lists are a count:u32 followed by their items. Integers are stored little endian as they are in memory.
+
+namespace {
+constexpr char MAGIC[8] = {'B', 'R', 'A', 'S', 'T', 0, 0, 0};
+constexpr uint8_t NULL_NODE = 0xFF;
+
+struct Writer {
+  string out;
+  bool failed = false;
+  unordered_map<utils::SymbolId, uint32_t> symbol_index = {{0, 0}};
+  vector<utils::SymbolId> symbols = {0};
+
+  template <typename T> void put(T value) {
+    out.append((const char *)&value, sizeof(T));
+  }
+
+  // LEB128. Counts, symbol indices and offsets are mostly small, so most take a byte or two.
+  void uint(uint64_t value) {
+    while (value >= 0x80) {
+      out += (char)(value | 0x80);
+      value >>= 7;
+    }
+
+    out += (char)value;
+  }
+
+  void str(string_view s) {
+    uint(s.length());
+    out += s;
+  }
+
+  void symbol(utils::SymbolId id) {
+    auto [it, inserted] = symbol_index.try_emplace(id, symbols.size());
+    if (inserted) {
+      symbols.push_back(id);
+    }
+
+    uint(it->second);
+  }
+
+  void property(const PropertyKey &prop) {
+    put<uint8_t>(prop.is_pub | prop.is_static << 1 | prop.variadic << 2);
+    symbol(prop.name);
+    type(prop.type);
+  }
+
+  void type(Type *type);
+  void expr(Expr *expr);
+  void stmt(Stmt *stmt);
+};
+
+void Writer::type(Type *type) {
+  if (!type) {
+    return put<uint8_t>(NULL_NODE);
+  }
+
+  put<uint8_t>(type->kind);
+
+  switch (type->kind) {
+  case SYMBOL_TYPE:
+    return symbol(static_cast<SymbolType *>(type)->symbol);
+  case POINTER_TYPE:
+    return this->type(static_cast<PointerType *>(type)->type);
+  case FN_TYPE: {
+    auto fn = static_cast<FnType *>(type);
+    put<uint8_t>(fn->variadic);
+    uint(fn->generics.size());
+    for (Type *generic : fn->generics) {
+      this->type(generic);
+    }
+
+    uint(fn->params.size());
+    for (const auto &param : fn->params) {
+      property(param);
+    }
+
+    return this->type(fn->returns);
+  }
+  default:
+    failed = true;
+  }
+}
+
+void Writer::expr(Expr *expr) {
+  if (!expr) {
+    return put<uint8_t>(NULL_NODE);
+  }
+
+  put<uint8_t>(expr->kind);
+
+  switch (expr->kind) {
+  case NUMBER_EXPR:
+    return str(static_cast<NumberExpr *>(expr)->value);
+  case STRING_EXPR:
+    return str(static_cast<StringExpr *>(expr)->value);
+  case SYMBOL_EXPR:
+    return symbol(static_cast<SymbolExpr *>(expr)->symbol);
+  case BINARY_EXPR: {
+    auto binary = static_cast<BinaryExpr *>(expr);
+    put<uint8_t>(binary->operation.kind);
+    uint(binary->operation.offset);
+    this->expr(binary->left);
+    return this->expr(binary->right);
+  }
+  case PREFIX_EXPR: {
+    auto prefix = static_cast<PrefixExpr *>(expr);
+    put<uint8_t>(prefix->operation.kind);
+    uint(prefix->operation.offset);
+    return this->expr(prefix->right);
+  }
+  case ASSIGN_EXPR: {
+    auto assignment = static_cast<AssignmentExpr *>(expr);
+    this->expr(assignment->assigne);
+    return this->expr(assignment->value);
+  }
+  case CALL_EXPR: {
+    auto call = static_cast<CallExpr *>(expr);
+    this->expr(call->calle);
+    uint(call->args.size());
+    for (Expr *arg : call->args) {
+      this->expr(arg);
+    }
+    return;
+  }
+  case LOG_MACRO:
+    return this->expr(static_cast<LogMacro *>(expr)->expr);
+  case STR_MACRO:
+    return this->expr(static_cast<StrMacro *>(expr)->expr);
+  case NUM_MACRO:
+    return this->expr(static_cast<NumMacro *>(expr)->expr);
+  case FMT_MACRO: {
+    auto fmt = static_cast<FmtMacro *>(expr);
+    str(fmt->formatString);
+    uint(fmt->args.size());
+    for (Expr *arg : fmt->args) {
+      this->expr(arg);
+    }
+    return;
+  }
+  default:
+    failed = true;
+  }
+}
+
+void Writer::stmt(Stmt *stmt) {
+  if (!stmt) {
+    return put<uint8_t>(NULL_NODE);
+  }
+
+  put<uint8_t>(stmt->kind);
+
+  switch (stmt->kind) {
+  case BLOCK_STMT: {
+    auto block = static_cast<BlockStmt *>(stmt);
+    uint(block->body.size());
+    for (Stmt *s : block->body) {
+      this->stmt(s);
+    }
+    return;
+  }
+  case EXPR_STMT:
+    return expr(static_cast<ExprStmt *>(stmt)->expr);
+  case VAR_DECL_STMT: {
+    auto decl = static_cast<VarDeclStmt *>(stmt);
+    put<uint8_t>(decl->constant);
+    symbol(decl->varname);
+    type(decl->type);
+    return expr(decl->value);
+  }
+  case FN_DECL_STMT: {
+    auto fn = static_cast<FnDeclStmt *>(stmt);
+    put<uint8_t>(fn->variadic);
+    symbol(fn->name);
+    uint(fn->params.size());
+    for (const auto &param : fn->params) {
+      property(param);
+    }
+
+    type(fn->return_type);
+    uint(fn->source_start);
+    uint(fn->source_end);
+
+    // A body skipped by a lazy parse keeps its source range and is built from the source when it is needed. Parsed
+    // bodies are prefixed with their size so loading can step over them.
+    if (!fn->body) {
+      put<uint8_t>(0);
+      uint(fn->body_start);
+      return uint(fn->body_end);
+    }
+
+    put<uint8_t>(1);
+    size_t start = out.size();
+    this->stmt(fn->body);
+
+    string body = out.substr(start);
+    out.resize(start);
+    uint(body.size());
+    out += body;
+    return;
+  }
+  case STRUCT_STMT: {
+    auto s = static_cast<StructStmt *>(stmt);
+    symbol(s->name);
+    uint(s->generics.size());
+    for (auto generic : s->generics) {
+      symbol(generic);
+    }
+
+    uint(s->properties.size());
+    for (const auto &prop : s->properties) {
+      property(prop);
+    }
+
+    put<uint8_t>(s->pub);
+    uint(s->public_status.size());
+    for (const auto &[name, pub] : s->public_status) {
+      symbol(name);
+      put<uint8_t>(pub);
+    }
+    return;
+  }
+  case IMPL_STMT:
+    return type(static_cast<ImplStmt *>(stmt)->type);
+  case DEFER_STMT: {
+    auto defer = static_cast<DeferStmt *>(stmt);
+    uint(defer->actions.size());
+    for (Expr *action : defer->actions) {
+      expr(action);
+    }
+    return;
+  }
+  case RETURN_STMT:
+    return expr(static_cast<ReturnStmt *>(stmt)->rhs);
+  case IMPORT_STMT: {
+    auto import = static_cast<ImportStmt *>(stmt);
+    str(import->path);
+    return symbol(import->alias);
+  }
+  default:
+    failed = true;
+  }
+}
+
+// Every read is bounds checked. Running off the end or meeting an unknown kind marks the reader as failed and the
+// snapshot is thrown away, so a truncated or damaged file costs a parse instead of a crash.
+struct Reader {
+  const char *pos;
+  const char *end;
+  ModuleStmt &mod;
+  Snapshot &snapshot;
+  bool failed = false;
+
+  Reader(const char *pos, const char *end, ModuleStmt &mod, Snapshot &snapshot)
+      : pos(pos), end(end), mod(mod), snapshot(snapshot) {
+  }
+
+  template <typename T> T get() {
+    T value{};
+    if ((size_t)(end - pos) < sizeof(T)) {
+      failed = true;
+      pos = end;
+      return value;
+    }
+
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+
+  uint64_t uint() {
+    uint64_t value = 0;
+
+    for (size_t shift = 0; pos < end && shift < 64; shift += 7) {
+      uint8_t byte = *pos++;
+      value |= (uint64_t)(byte & 0x7F) << shift;
+
+      if (byte < 0x80) {
+        return value;
+      }
+    }
+
+    failed = true;
+    pos = end;
+    return 0;
+  }
+
+  // Counts and lengths never exceed the bytes left since every item takes at least one, so anything larger can only
+  // come from a damaged file.
+  uint32_t count() {
+    uint64_t n = uint();
+    if (n > (size_t)(end - pos)) {
+      failed = true;
+      return 0;
+    }
+
+    return n;
+  }
+
+  string_view bytes() {
+    uint32_t length = count();
+    string_view s(pos, length);
+    pos += length;
+    return s;
+  }
+
+  string str() {
+    return string(bytes());
+  }
+
+  utils::SymbolId symbol() {
+    uint64_t index = uint();
+    if (index >= snapshot.ids.size()) {
+      failed = true;
+      return 0;
+    }
+
+    if (snapshot.ids[index] == Snapshot::UNINTERNED) {
+      snapshot.ids[index] = utils::intern(snapshot.names[index]);
+    }
+
+    return snapshot.ids[index];
+  }
+
+  PropertyKey property() {
+    uint8_t flags = get<uint8_t>();
+    PropertyKey prop;
+    prop.is_pub = flags & 1;
+    prop.is_static = flags & 2;
+    prop.variadic = flags & 4;
+    prop.name = symbol();
+    prop.type = type();
+    return prop;
+  }
+
+  template <typename T> T *make() {
+    return mod.arena.make<T>();
+  }
+
+  Type *type();
+  Expr *expr();
+  Stmt *stmt();
+};
+
+Type *Reader::type() {
+  uint8_t kind = get<uint8_t>();
+
+  switch (kind) {
+  case NULL_NODE:
+    return nullptr;
+  case SYMBOL_TYPE:
+    return mod.arena.make<SymbolType>(symbol());
+  case POINTER_TYPE: {
+    auto pointer = make<PointerType>();
+    pointer->type = type();
+    return pointer;
+  }
+  case FN_TYPE: {
+    auto fn = make<FnType>();
+    fn->variadic = get<uint8_t>();
+    fn->generics.resize(count());
+    for (auto &generic : fn->generics) {
+      generic = type();
+    }
+
+    fn->params.resize(count());
+    for (auto &param : fn->params) {
+      param = property();
+    }
+
+    fn->returns = type();
+    return fn;
+  }
+  }
+
+  failed = true;
+  return nullptr;
+}
+
+Expr *Reader::expr() {
+  uint8_t kind = get<uint8_t>();
+
+  switch (kind) {
+  case NULL_NODE:
+    return nullptr;
+  case NUMBER_EXPR: {
+    auto number = make<NumberExpr>();
+    number->value = str();
+    return number;
+  }
+  case STRING_EXPR: {
+    auto literal = make<StringExpr>();
+    literal->value = str();
+    return literal;
+  }
+  case SYMBOL_EXPR: {
+    auto symbol = make<SymbolExpr>();
+    symbol->symbol = this->symbol();
+    return symbol;
+  }
+  case BINARY_EXPR: {
+    auto binary = make<BinaryExpr>();
+    binary->operation.kind = (lexer::TokenKind)get<uint8_t>();
+    binary->operation.offset = uint();
+    binary->left = expr();
+    binary->right = expr();
+    return binary;
+  }
+  case PREFIX_EXPR: {
+    auto prefix = make<PrefixExpr>();
+    prefix->operation.kind = (lexer::TokenKind)get<uint8_t>();
+    prefix->operation.offset = uint();
+    prefix->right = expr();
+    return prefix;
+  }
+  case ASSIGN_EXPR: {
+    auto assignment = make<AssignmentExpr>();
+    assignment->assigne = expr();
+    assignment->value = expr();
+    return assignment;
+  }
+  case CALL_EXPR: {
+    auto call = make<CallExpr>();
+    call->calle = expr();
+    call->args.resize(count());
+    for (auto &arg : call->args) {
+      arg = expr();
+    }
+    return call;
+  }
+  case LOG_MACRO: {
+    auto log = make<LogMacro>();
+    log->expr = expr();
+    return log;
+  }
+  case STR_MACRO: {
+    auto str = make<StrMacro>();
+    str->expr = expr();
+    return str;
+  }
+  case NUM_MACRO: {
+    auto num = make<NumMacro>();
+    num->expr = expr();
+    return num;
+  }
+  case FMT_MACRO: {
+    auto fmt = make<FmtMacro>();
+    fmt->formatString = str();
+    fmt->args.resize(count());
+    for (auto &arg : fmt->args) {
+      arg = expr();
+    }
+    return fmt;
+  }
+  }
+
+  failed = true;
+  return nullptr;
+}
+
+Stmt *Reader::stmt() {
+  uint8_t kind = get<uint8_t>();
+
+  switch (kind) {
+  case NULL_NODE:
+    return nullptr;
+  case BLOCK_STMT: {
+    auto block = make<BlockStmt>();
+    block->body.resize(count());
+    for (auto &s : block->body) {
+      s = stmt();
+    }
+    return block;
+  }
+  case EXPR_STMT: {
+    auto expr_stmt = make<ExprStmt>();
+    expr_stmt->expr = expr();
+    return expr_stmt;
+  }
+  case VAR_DECL_STMT: {
+    auto decl = make<VarDeclStmt>();
+    decl->constant = get<uint8_t>();
+    decl->varname = symbol();
+    decl->type = type();
+    decl->value = expr();
+    return decl;
+  }
+  case FN_DECL_STMT: {
+    auto fn = make<FnDeclStmt>();
+    fn->variadic = get<uint8_t>();
+    fn->name = symbol();
+    fn->params.resize(count());
+    for (auto &param : fn->params) {
+      param = property();
+    }
+
+    fn->return_type = type();
+    fn->source_start = uint();
+    fn->source_end = uint();
+
+    // Parsed bodies are stepped over and built from the mapping by load_cached_body when they are needed.
+    fn->module = &mod;
+    fn->body_cached = get<uint8_t>();
+
+    if (fn->body_cached) {
+      uint32_t size = count();
+      fn->body_start = pos - snapshot.mapping->contents.data();
+      fn->body_end = fn->body_start + size;
+      pos += size;
+      return fn;
+    }
+
+    fn->body_start = uint();
+    fn->body_end = uint();
+    return fn;
+  }
+  case STRUCT_STMT: {
+    auto s = make<StructStmt>();
+    s->name = symbol();
+    s->generics.resize(count());
+    for (auto &generic : s->generics) {
+      generic = symbol();
+    }
+
+    s->properties.resize(count());
+    for (auto &prop : s->properties) {
+      prop = property();
+    }
+
+    s->pub = get<uint8_t>();
+    for (uint32_t i = 0, n = count(); i < n; i++) {
+      auto name = symbol();
+      s->public_status[name] = get<uint8_t>();
+    }
+    return s;
+  }
+  case IMPL_STMT: {
+    auto impl = make<ImplStmt>();
+    impl->type = type();
+    return impl;
+  }
+  case DEFER_STMT: {
+    auto defer = make<DeferStmt>();
+    defer->actions.resize(count());
+    for (auto &action : defer->actions) {
+      action = expr();
+    }
+    return defer;
+  }
+  case RETURN_STMT: {
+    auto ret = make<ReturnStmt>();
+    ret->rhs = expr();
+    return ret;
+  }
+  case IMPORT_STMT: {
+    auto import = make<ImportStmt>();
+    import->path = str();
+    import->alias = symbol();
+    return import;
+  }
+  }
+
+  failed = true;
+  return nullptr;
+}
+}; // namespace
+
+uint64_t ast::module_hash(string_view path, string_view contents) {
+  const uint64_t PRIME = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull;
+
+  // FNV-1a taking a whole word per step, which is plenty to notice an edit and keeps hashing far cheaper than lexing.
+  auto mix = [&](string_view bytes) {
+    size_t i = 0;
+    for (; i + 8 <= bytes.length(); i += 8) {
+      uint64_t word;
+      memcpy(&word, bytes.data() + i, 8);
+      hash = (hash ^ word) * PRIME;
+    }
+
+    for (; i < bytes.length(); i++) {
+      hash = (hash ^ (uint8_t)bytes[i]) * PRIME;
+    }
+
+    hash = (hash ^ bytes.length()) * PRIME;
+  };
+
+  mix(path);
+  mix(BEDROCK_VERSION);
+  hash = (hash ^ CACHE_FORMAT_VERSION) * PRIME;
+  mix(contents);
+  return hash;
+}
+
+string ast::serialize_module(ModuleStmt &mod) {
+  Writer body;
+  body.uint(mod.body.size());
+  for (Stmt *stmt : mod.body) {
+    body.stmt(stmt);
+  }
+
+  if (body.failed) {
+    return "";
+  }
+
+  Writer out;
+  out.out.append(MAGIC, sizeof(MAGIC));
+  out.put<uint32_t>(CACHE_FORMAT_VERSION);
+  out.put<uint64_t>(module_hash(mod.file->file_path, mod.file->contents));
+
+  out.uint(body.symbols.size() - 1);
+  for (size_t i = 1; i < body.symbols.size(); i++) {
+    out.str(utils::symbol_str(body.symbols[i]));
+  }
+
+  return out.out + body.out;
+}
+
+shared_ptr<ModuleStmt> ast::deserialize_module(shared_ptr<lexer::SourceFile> snapshot,
+                                               shared_ptr<lexer::SourceFile> file) {
+  string_view data = snapshot->contents;
+  if (data.length() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    return nullptr;
+  }
+
+  auto mod = make_shared<ModuleStmt>();
+  mod->name = file->file_path;
+  mod->file = file;
+  mod->snapshot = make_shared<Snapshot>();
+  mod->snapshot->mapping = snapshot;
+
+  Snapshot &snap = *mod->snapshot;
+  Reader reader{data.data() + sizeof(MAGIC), data.data() + data.length(), *mod, snap};
+  if (reader.get<uint32_t>() != CACHE_FORMAT_VERSION ||
+      reader.get<uint64_t>() != module_hash(file->file_path, file->contents)) {
+    return nullptr;
+  }
+
+  // Names are interned the first time a node refers to them, so symbols only used inside bodies cost nothing here.
+  size_t names = reader.count() + 1;
+  snap.names.resize(names);
+  snap.ids.assign(names, Snapshot::UNINTERNED);
+  snap.ids[0] = 0;
+  for (size_t i = 1; i < names; i++) {
+    snap.names[i] = reader.bytes();
+  }
+
+  mod->body.resize(reader.count());
+  for (auto &stmt : mod->body) {
+    stmt = reader.stmt();
+  }
+
+  if (reader.failed || reader.pos != reader.end) {
+    return nullptr;
+  }
+
+  return mod;
+}
+
+BlockStmt *ast::load_cached_body(FnDeclStmt *fn) {
+  ModuleStmt &mod = *fn->module;
+  const char *base = mod.snapshot->mapping->contents.data();
+
+  Reader reader{base + fn->body_start, base + fn->body_end, mod, *mod.snapshot};
+  Stmt *body = reader.stmt();
+
+  // The whole snapshot was validated against the source when it was loaded, so this only happens if the mapped file
+  // was damaged on disk. The module cannot be parsed again at this point.
+  if (reader.failed || reader.pos != reader.end || !body || body->kind != BLOCK_STMT) {
+    throw Err(ErrKind::Fatal)
+        .message("The AST cache of " + bold_white(mod.name) + " is damaged.")
+        .hint("Delete " + COMPILED_FILES_PATH + " or run with --no-cache.");
+  }
+
+  fn->body_cached = false;
+  fn->body = static_cast<BlockStmt *>(body);
+  return fn->body;
+}
+
+string ast::cache_path(const string &file_path) {
+  auto normalized = std::filesystem::path(file_path).lexically_normal().string();
+  return COMPILED_FILES_PATH + "ast/" + utils::sanitize_file_path(normalized) + ".ast";
+}
+
+shared_ptr<ModuleStmt> ast::load_cached_module(shared_ptr<lexer::SourceFile> file) {
+  // SourceFile memory maps whatever it opens, which is all a snapshot needs.
+  auto snapshot = lexer::SourceFile::open(cache_path(file->file_path));
+  if (!snapshot) {
+    return nullptr;
+  }
+
+  return deserialize_module(snapshot, file);
+}
+
+void ast::store_cached_module(ModuleStmt &mod) {
+  string data = serialize_module(mod);
+  if (data.empty()) {
+    return;
+  }
+
+  // Renamed into place, so a concurrent run never maps a half written snapshot.
+  utils::write_file_atomic(cache_path(mod.file->file_path), data);
+}
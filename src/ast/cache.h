@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ast_stmt.h"
+
+namespace ast {
+/// @brief Changes whenever the binary layout written by serialize_module changes.
+constexpr uint32_t CACHE_FORMAT_VERSION = 2;
+
+/// @brief A memory mapped snapshot backing a module loaded from the cache. Function bodies stay encoded inside the
+/// mapping until load_cached_body builds them, so loading a module only touches its top level declarations.
+struct Snapshot {
+  shared_ptr<lexer::SourceFile> mapping;
+  vector<string_view> names;   // symbol table, views into the mapping
+  vector<utils::SymbolId> ids; // names interned on first use, UNINTERNED until then
+
+  static constexpr utils::SymbolId UNINTERNED = UINT32_MAX;
+};
+
+/// @brief Hash of everything a parsed module depends on: the path it was read from (imports are resolved relative to
+/// it), the source, the compiler version and the cache format.
+uint64_t module_hash(string_view path, string_view contents);
+
+/// @brief Encodes mod into a compact binary snapshot. Nodes are written in pre-order, integers as varints and symbols
+/// as indices into a table of names, since interned ids differ between runs.
+string serialize_module(ModuleStmt &mod);
+/// @brief Rebuilds the top level of a module written by serialize_module. file is the source the module was parsed
+/// from. Returns nullptr when the snapshot is truncated or was written for a different source or compiler version.
+shared_ptr<ModuleStmt> deserialize_module(shared_ptr<lexer::SourceFile> snapshot, shared_ptr<lexer::SourceFile> file);
+/// @brief Builds the body of a function loaded from a snapshot. See FnDeclStmt::body_cached. Throws an Err when the
+/// mapped snapshot was damaged on disk.
+BlockStmt *load_cached_body(FnDeclStmt *fn);
+
+/// @brief Path of the snapshot of the module at file_path inside COMPILED_FILES_PATH.
+string cache_path(const string &file_path);
+/// @brief Memory maps the snapshot of file and rebuilds the module from it. Returns nullptr when there is no snapshot
+/// or it is stale.
+shared_ptr<ModuleStmt> load_cached_module(shared_ptr<lexer::SourceFile> file);
+/// @brief Writes the snapshot of mod. Failing to write it is not an error, the module is parsed again next run.
+void store_cached_module(ModuleStmt &mod);
+}; // namespace ast
@@ -0,0 +1,237 @@
+#include "dump.h"
+
+#include "../util/fmt.h"
+
+using namespace ast;
+
+const char *ast::node_name(NodeKind kind) {
+  switch (kind) {
+  case PROGRAM_STMT:
+    return "Program";
+  case MODULE_STMT:
+    return "Module";
+  case BLOCK_STMT:
+    return "Block";
+  case VAR_DECL_STMT:
+    return "VarDecl";
+  case FN_DECL_STMT:
+    return "FnDecl";
+  case RETURN_STMT:
+    return "Return";
+  case IMPORT_STMT:
+    return "Import";
+  case STRUCT_STMT:
+    return "Struct";
+  case IMPL_STMT:
+    return "Impl";
+  case DEFER_STMT:
+    return "Defer";
+  case EXPR_STMT:
+    return "ExprStmt";
+  case NUMBER_EXPR:
+    return "Number";
+  case STRING_EXPR:
+    return "String";
+  case SYMBOL_EXPR:
+    return "Symbol";
+  case BINARY_EXPR:
+    return "Binary";
+  case PREFIX_EXPR:
+    return "Prefix";
+  case ASSIGN_EXPR:
+    return "Assignment";
+  case CALL_EXPR:
+    return "Call";
+  case SYMBOL_TYPE:
+    return "SymbolType";
+  case POINTER_TYPE:
+    return "PointerType";
+  case FN_TYPE:
+    return "FnType";
+  case LOG_MACRO:
+    return "@Log";
+  case FMT_MACRO:
+    return "@Fmt";
+  case STR_MACRO:
+    return "@Str";
+  case NUM_MACRO:
+    return "@Num";
+  }
+
+  return "Unknown";
+}
+
+void ast::dump_properties(Dumper &out, const char *name, const vector<PropertyKey> &props) {
+  out.key(name);
+  out.open_list();
+
+  for (const auto &prop : props) {
+    out.open("Property");
+    out.field("name", utils::symbol_name(prop.name));
+    out.flag("pub", prop.is_pub || prop.is_static);
+    out.flag("static", prop.is_static);
+    out.child("type", prop.type);
+    out.close();
+  }
+
+  out.close_list();
+}
+
+//  TextDumper
+
+void TextDumper::indent() {
+  for (size_t i = 0; i < depth; i++) {
+    out << "  ";
+  }
+}
+
+// A key followed by a node or a list gets a line of its own and the value is indented below it.
+bool TextDumper::key_line() {
+  if (!pending) {
+    return false;
+  }
+
+  indent();
+  out << magenta(pending) << ":\n";
+  pending = nullptr;
+  depth++;
+  return true;
+}
+
+void TextDumper::heading(const string &name) {
+  keyed.push_back(key_line());
+  indent();
+  out << name << "\n";
+  depth++;
+}
+
+void TextDumper::open(NodeKind kind) {
+  const char *name = node_name(kind);
+
+  if (kind <= EXPR_STMT) {
+    heading(bold_magenta(name));
+  } else if (kind <= CALL_EXPR) {
+    heading(bold_blue(name));
+  } else if (kind <= FN_TYPE) {
+    heading(bold_yellow(name));
+  } else {
+    heading(red(name));
+  }
+}
+
+void TextDumper::open(const char *record) {
+  heading(bold_green(record));
+}
+
+void TextDumper::close() {
+  depth -= keyed.back() ? 2 : 1;
+  keyed.pop_back();
+}
+
+void TextDumper::open_list() {
+  keyed.push_back(key_line());
+}
+
+void TextDumper::close_list() {
+  depth -= keyed.back() ? 1 : 0;
+  keyed.pop_back();
+}
+
+void TextDumper::key(const char *name) {
+  pending = name;
+}
+
+void TextDumper::write_text(string_view text) {
+  indent();
+
+  if (pending) {
+    out << blue(pending) << ": ";
+    pending = nullptr;
+  }
+
+  out << yellow(string(text)) << "\n";
+}
+
+void TextDumper::write_flag(bool flag) {
+  write_text(flag ? "true" : "false");
+}
+
+void TextDumper::write_none() {
+  write_text("none");
+}
+
+//  JsonDumper
+
+void JsonDumper::separate() {
+  if (keyed) {
+    keyed = false;
+    return;
+  }
+
+  if (!empty.empty()) {
+    if (!empty.back()) {
+      out << ',';
+    }
+
+    empty.back() = false;
+  }
+}
+
+void JsonDumper::end_value() {
+  if (empty.empty()) {
+    out << '\n';
+  }
+}
+
+void JsonDumper::open(NodeKind kind) {
+  open(node_name(kind));
+}
+
+void JsonDumper::open(const char *record) {
+  separate();
+  out << "{\"kind\":";
+  utils::write_json_string(out, record);
+  empty.push_back(false);
+}
+
+void JsonDumper::close() {
+  out << '}';
+  empty.pop_back();
+  end_value();
+}
+
+void JsonDumper::open_list() {
+  separate();
+  out << '[';
+  empty.push_back(true);
+}
+
+void JsonDumper::close_list() {
+  out << ']';
+  empty.pop_back();
+  end_value();
+}
+
+void JsonDumper::key(const char *name) {
+  separate();
+  out << '"' << name << "\":";
+  keyed = true;
+}
+
+void JsonDumper::write_text(string_view text) {
+  separate();
+  utils::write_json_string(out, text);
+  end_value();
+}
+
+void JsonDumper::write_flag(bool flag) {
+  separate();
+  out << (flag ? "true" : "false");
+  end_value();
+}
+
+void JsonDumper::write_none() {
+  separate();
+  out << "null";
+  end_value();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <sstream>
+
+#include "ast.h"
+
+namespace ast {
+/// @brief Returns the name a node is dumped under, such as FnDecl or Binary.
+const char *node_name(NodeKind kind);
+
+/// @brief Receives the structure of a tree from the dump methods of its nodes and writes it out as it goes, so no
+/// part of a dump is held in memory. A node is opened, described by its fields and closed again. key names the value
+/// written right after it: a text or flag, a nested node or a list of nodes.
+class Dumper {
+public:
+  virtual ~Dumper() {
+  }
+
+  virtual void open(NodeKind kind) = 0;
+  /// @brief Opens a group of fields which is not a node of its own, such as the property of a struct.
+  virtual void open(const char *record) = 0;
+  virtual void close() = 0;
+  virtual void open_list() = 0;
+  virtual void close_list() = 0;
+
+  virtual void key(const char *name) = 0;
+  virtual void write_text(string_view text) = 0;
+  virtual void write_flag(bool flag) = 0;
+  /// @brief Stands in for an optional node which is absent.
+  virtual void write_none() = 0;
+
+  void field(const char *name, string_view text) {
+    key(name);
+    write_text(text);
+  }
+
+  void flag(const char *name, bool flag) {
+    key(name);
+    write_flag(flag);
+  }
+
+  template <typename Node> void child(const char *name, Node *node) {
+    key(name);
+    node ? node->dump(*this) : write_none();
+  }
+
+  template <typename List> void children(const char *name, const List &nodes) {
+    key(name);
+    open_list();
+    for (const auto &node : nodes) {
+      node->dump(*this);
+    }
+
+    close_list();
+  }
+};
+
+/// @brief Writes the indented and colored dump printed by --ast.
+class TextDumper : public Dumper {
+public:
+  TextDumper(std::ostream &out) : out(out) {
+  }
+
+  void open(NodeKind kind);
+  void open(const char *record);
+  void close();
+  void open_list();
+  void close_list();
+  void key(const char *name);
+  void write_text(string_view text);
+  void write_flag(bool flag);
+  void write_none();
+
+private:
+  std::ostream &out;
+  size_t depth = 0;
+  const char *pending = nullptr; // key waiting for its value
+  vector<bool> keyed;            // whether each open node or list sits below a key line, which indents it once more
+
+  void indent();
+  bool key_line();
+  void heading(const string &name);
+};
+
+/// @brief Writes a dump as JSON. Nodes become objects whose "kind" is their node_name and lists become arrays. Every
+/// top level value is ended by a newline, so dumping several trees in a row gives NDJSON.
+class JsonDumper : public Dumper {
+public:
+  JsonDumper(std::ostream &out) : out(out) {
+  }
+
+  void open(NodeKind kind);
+  void open(const char *record);
+  void close();
+  void open_list();
+  void close_list();
+  void key(const char *name);
+  void write_text(string_view text);
+  void write_flag(bool flag);
+  void write_none();
+
+private:
+  std::ostream &out;
+  bool keyed = false; // a key was just written, so the next value needs no separator
+  vector<bool> empty; // whether each open object or array has nothing in it yet
+
+  void separate();
+  void end_value();
+};
+
+/// @brief Dumps struct properties or function parameters as a list of Property records.
+void dump_properties(Dumper &out, const char *name, const vector<PropertyKey> &props);
+
+/// @brief Renders a tree with a TextDumper into a string. Large trees should be streamed instead.
+template <typename Node> string debug_str(Node *node) {
+  std::ostringstream out;
+  TextDumper dumper{out};
+  node->dump(dumper);
+  return out.str();
+}
+}; // namespace ast
@@ -0,0 +1,95 @@
+#include "flat.h"
+
+using namespace ast;
+
+pair<AssignTarget, utils::SymbolId> ast::assign_target(Expr *assigne) {
+  if (assigne->kind == SYMBOL_EXPR) {
+    return make_pair(ASSIGN_SYMBOL, static_cast<SymbolExpr *>(assigne)->symbol);
+  }
+
+  if (assigne->kind == PREFIX_EXPR) {
+    auto prefix = static_cast<PrefixExpr *>(assigne);
+
+    if (prefix->operation.kind == lexer::STAR && prefix->right->kind == SYMBOL_EXPR) {
+      return make_pair(ASSIGN_DEREF, static_cast<SymbolExpr *>(prefix->right)->symbol);
+    }
+  }
+
+  return make_pair(ASSIGN_INVALID, 0);
+}
+
+NodeIndex FlatExprs::push(NodeKind kind, NodeIndex begin, uint32_t lhs, uint32_t rhs, uint32_t payload) {
+  kinds.push_back((uint8_t)kind);
+  begins.push_back(begin);
+  this->lhs.push_back(lhs);
+  this->rhs.push_back(rhs);
+  payloads.push_back(payload);
+  return (NodeIndex)kinds.size() - 1;
+}
+
+// Operands are flattened first so their roots are known, then copied into lists as one contiguous run.
+uint32_t FlatExprs::push_list(const vector<Expr *> &exprs) {
+  vector<NodeIndex> roots;
+  roots.reserve(exprs.size());
+
+  for (Expr *expr : exprs) {
+    roots.push_back(append(expr));
+  }
+
+  uint32_t first = lists.size();
+  lists.insert(lists.end(), roots.begin(), roots.end());
+  return first;
+}
+
+NodeIndex FlatExprs::append(Expr *expr) {
+  NodeIndex begin = size();
+
+  switch (expr->kind) {
+  case NUMBER_EXPR:
+    numbers.push_back(std::stod(static_cast<NumberExpr *>(expr)->value));
+    return push(NUMBER_EXPR, begin, numbers.size() - 1, 0, 0);
+  case STRING_EXPR:
+    strings.push_back(static_cast<StringExpr *>(expr)->value);
+    return push(STRING_EXPR, begin, strings.size() - 1, 0, 0);
+  case SYMBOL_EXPR:
+    return push(SYMBOL_EXPR, begin, 0, 0, static_cast<SymbolExpr *>(expr)->symbol);
+  case BINARY_EXPR: {
+    auto binary = static_cast<BinaryExpr *>(expr);
+    NodeIndex left = append(binary->left);
+    NodeIndex right = append(binary->right);
+    return push(BINARY_EXPR, begin, left, right, binary->operation.kind);
+  }
+  case PREFIX_EXPR: {
+    auto prefix = static_cast<PrefixExpr *>(expr);
+    NodeIndex right = append(prefix->right);
+    return push(PREFIX_EXPR, begin, right, 0, prefix->operation.kind);
+  }
+  case ASSIGN_EXPR: {
+    auto assignment = static_cast<AssignmentExpr *>(expr);
+    auto [target, symbol] = assign_target(assignment->assigne);
+    NodeIndex value = append(assignment->value);
+    return push(ASSIGN_EXPR, begin, value, symbol, target);
+  }
+  case CALL_EXPR: {
+    auto call = static_cast<CallExpr *>(expr);
+    NodeIndex callee = append(call->calle);
+    uint32_t first = push_list(call->args);
+    return push(CALL_EXPR, begin, callee, first, call->args.size());
+  }
+  case LOG_MACRO:
+    return push(LOG_MACRO, begin, append(static_cast<LogMacro *>(expr)->expr), 0, 0);
+  case STR_MACRO:
+    return push(STR_MACRO, begin, append(static_cast<StrMacro *>(expr)->expr), 0, 0);
+  case NUM_MACRO:
+    return push(NUM_MACRO, begin, append(static_cast<NumMacro *>(expr)->expr), 0, 0);
+  case FMT_MACRO: {
+    auto fmt = static_cast<FmtMacro *>(expr);
+    uint32_t first = push_list(fmt->args);
+    strings.push_back(fmt->formatString);
+    return push(FMT_MACRO, begin, strings.size() - 1, first, fmt->args.size());
+  }
+  default:
+    std::cout << "FlatExprs::append() unknown kind: " << expr->kind << "\n";
+    exit(1);
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ast_expr.h"
+#include "ast_macro.h"
+
+namespace ast {
+/// @brief Index of a node inside FlatExprs.
+typedef uint32_t NodeIndex;
+
+/// @brief What the left hand side of an assignment writes to. It is kept as a payload of the assignment rather than as
+/// an operand because it is written to, never evaluated.
+enum AssignTarget : uint32_t {
+  ASSIGN_SYMBOL,  // x = value
+  ASSIGN_DEREF,   // *x = value
+  ASSIGN_INVALID, // anything else
+};
+
+/// @brief Classifies the left hand side of an assignment. The symbol is 0 for ASSIGN_INVALID.
+pair<AssignTarget, utils::SymbolId> assign_target(Expr *assigne);
+
+/// @brief Linearized expression trees. Nodes live in parallel columns in post-order, so the operands of a node always
+/// come before it and a pass which only needs its operands' results can walk the arrays front to back. Several
+/// expressions can be appended to the same FlatExprs, each occupies a contiguous range ending at its root.
+///
+/// Columns per kind:
+///   NUMBER_EXPR        lhs: index into numbers
+///   STRING_EXPR        lhs: index into strings
+///   SYMBOL_EXPR        payload: symbol
+///   BINARY_EXPR        lhs, rhs: operands. payload: operator TokenKind
+///   PREFIX_EXPR        lhs: operand. payload: operator TokenKind
+///   ASSIGN_EXPR        lhs: value. rhs: target symbol. payload: AssignTarget
+///   CALL_EXPR          lhs: callee. rhs: index of the first argument in lists. payload: argument count
+///   LOG/STR/NUM_MACRO  lhs: operand
+///   FMT_MACRO          lhs: index of the format string in strings. rhs, payload: arguments, as for CALL_EXPR
+struct FlatExprs {
+  vector<uint8_t> kinds;    // NodeKind
+  vector<NodeIndex> begins; // first node of the subtree rooted at each node, which spans [begins[i], i]
+  vector<uint32_t> lhs;
+  vector<uint32_t> rhs;
+  vector<uint32_t> payloads;
+
+  vector<NodeIndex> lists; // argument lists of calls and macros
+  vector<double> numbers;
+  vector<string> strings;
+
+  size_t size() const {
+    return kinds.size();
+  }
+
+  NodeKind kind(NodeIndex i) const {
+    return (NodeKind)kinds[i];
+  }
+
+  /// @brief Appends expr and all of its operands and returns the index of expr.
+  NodeIndex append(Expr *expr);
+
+private:
+  NodeIndex push(NodeKind kind, NodeIndex begin, uint32_t lhs, uint32_t rhs, uint32_t payload);
+  uint32_t push_list(const vector<Expr *> &exprs);
+};
+}; // namespace ast
@@ -10,7 +10,10 @@ inline bool COLORS_ENABLED = true;
 inline bool DISPLAY_AST = false;
 inline bool DISPLAY_TOKENS = false;
 inline bool DISPLAY_TYPEINFO = false;
+inline bool DUMP_JSON = false;
 inline bool DISABLE_BOUND_CHECKING = false;
+inline bool LAZY_FN_BODIES = false;
+inline bool AST_CACHE = true;
 inline string COMPILED_FILES_PATH = ".builds/";
 
 int display_help() {
@@ -31,6 +34,13 @@ int display_help() {
                 "contain "
                 "the entry point of the application.\n");
 
+  // CHECK
+  cout << bold_blue("\n(check)");
+  cout << yellow(" `bedrock check path/to/file.br`\n");
+  cout << "  - " << white("Type checks the program without building or running it.\n") << "  - ";
+  cout << white("Function bodies which did not change since the last check, and whose dependencies did not either, "
+                "are not checked again.\n");
+
   cout << "\n\n";
 
   // --no-color
@@ -43,6 +53,19 @@ int display_help() {
        << white("Disables bound checking at compile time. Often improves "
                 "performance at the cost of safety.\n");
 
+  // --lazy-bodies
+  cout << bold_magenta("\n[--lazy-bodies]") << "\n";
+  cout << "  -"
+       << white("Skips over function bodies while parsing and only builds them once they are needed. The bodies of "
+                "imported modules are only built and checked once something calls them, so functions which go "
+                "unused are never built. (check) still checks every body.\n");
+
+  // --no-cache
+  cout << bold_magenta("\n[--no-cache]") << "\n";
+  cout << "  -"
+       << white("Parses every module from source instead of loading the modules which did not change since the last "
+                "run from " + COMPILED_FILES_PATH + ".\n");
+
   // -----------
   // DEBUG FLAGS
   cout << bold_cyan("\n\n[--ast]\n");
@@ -51,6 +74,9 @@ int display_help() {
   cout << bold_cyan("\n[--tokens]\n");
   cout << "  - " << white("Prints lexer output to stdout.\n");
 
+  cout << bold_cyan("\n[--json]\n");
+  cout << "  - " << white("Prints --ast and --tokens as JSON, one module or token per line.\n");
+
   cout << bold_cyan("\n[--types]\n");
   cout << "  - "
        << white("Prints type, scope and variable/symbol usage to stdout after "
@@ -68,12 +94,28 @@ int bedrock_run(string file_path) {
   compiler::Compiler compiler;
 
   auto program = parser::parse(file_path);
+
+  if (!program) {
+    return 1;
+  }
+
   analysis::tc_program(program);
   compiler.compile(program, BYTECODE_PATH);
 
   return 0;
 }
 
+int bedrock_check(string file_path) {
+  auto program = parser::parse(file_path, true);
+
+  if (!program) {
+    return 1;
+  }
+
+  analysis::tc_program(program, true);
+  return 0;
+}
+
 pair<optional<string>, vector<string>> parse_args(int argc, const char **argv) {
   optional<string> command;
   vector<string> args;
@@ -101,6 +143,14 @@ void set_flags(vector<string> &args) {
       DISABLE_BOUND_CHECKING = true;
     }
 
+    if (arg == "--lazy-bodies") {
+      LAZY_FN_BODIES = true;
+    }
+
+    if (arg == "--no-cache") {
+      AST_CACHE = false;
+    }
+
     if (arg == "--ast") {
       DISPLAY_AST = true;
     }
@@ -109,6 +159,10 @@ void set_flags(vector<string> &args) {
       DISPLAY_TOKENS = true;
     }
 
+    if (arg == "--json") {
+      DUMP_JSON = true;
+    }
+
     if (arg == "--types") {
       DISPLAY_TYPEINFO = true;
     }
@@ -143,6 +197,15 @@ int main(int argc, const char **argv) {
       return bedrock_run(args[0]);
     }
 
+    if (command == "check") {
+      if (args.size() == 0) {
+        std::cout << "\nImproper usage of (check) command.";
+        return display_help();
+      }
+
+      return bedrock_check(args[0]);
+    }
+
     if (command == "help" || command == "info") {
       return display_help();
     }
@@ -10,7 +10,7 @@
 #define BEDROCK_EXTENSION ".br"
 #define BEDROCK_GITHUB "https://github.com/tlaceby/bedrock/"
 
-#define byte uint8_t
+typedef uint8_t byte;
 
 /// @brief Supresses Unused message from clang/gcc
 #define UNUSED(x) (void)(x)
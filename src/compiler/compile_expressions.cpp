@@ -16,27 +16,54 @@ void Compiler::compile_string_expr(StringExpr *expr, shared_ptr<analysis::Scope>
   emit(getConstantAddr(expr->value));
 }
 
-void Compiler::compile_symbol_expr(SymbolExpr *expr, shared_ptr<analysis::Scope> env) {
-  string varname = expr->symbol;
-  analysis::Scope *scope = env->resolveSymbolScope(varname);
+void Compiler::compile_symbol_expr(SymbolExpr *expr) {
+  compile_binding(expr->binding, expr->symbol);
+}
+
+// Flat expressions only hold the symbol, so it is bound here instead of during analysis.
+void Compiler::compile_symbol(utils::SymbolId varname, shared_ptr<analysis::Scope> env) {
+  compile_binding(env->bind(varname), varname);
+}
 
-  // Global Variable
-  if (scope->is_global || scope->is_module) {
+void Compiler::compile_binding(const analysis::Binding &binding, utils::SymbolId varname) {
+  switch (binding.kind) {
+  case analysis::Binding::GLOBAL:
+    emit(op_loadg);
+    emit(binding.slot);
+    return;
+  case analysis::Binding::MODULE:
     emit(op_loadg);
-    emit(globals_lu[getGlobalName(varname)]);
+    emit(globals_base + binding.slot);
     return;
+  case analysis::Binding::LOCAL:
+    if (binding.depth == 0) {
+      emit(op_loadl);
+      emit(binding.slot);
+      return;
+    }
+
+    std::cout << "Compile::symbol() " << utils::symbol_str(varname) << " is captured from an enclosing function\n";
+    TODO("Unimplimented captured variables");
+  case analysis::Binding::UNBOUND:
+    break;
   }
 
-  // Local Variable
-  emit(op_loadl);
-  emit(scope->local_offsets[varname]); // TODO: Wont work with multiple scopes
+  std::cout << "Compile::symbol() " << utils::symbol_str(varname) << " was never bound by analysis\n";
+  exit(1);
 }
 
 void Compiler::compile_binary_expr(BinaryExpr *expr, shared_ptr<analysis::Scope> env) {
   compile_expr(expr->left, env);
   compile_expr(expr->right, env);
 
-  switch (expr->operation.kind) {
+  // Only + needs the type of its operands, to pick between numeric addition and string concatenation. Analysis left it
+  // on the operand.
+  auto leftKind = expr->operation.kind == lexer::PLUS ? analysis::type_of(expr->left->type_id) : nullptr;
+  compile_binary_op(expr->operation.kind, leftKind);
+}
+
+void Compiler::compile_binary_op(lexer::TokenKind op, shared_ptr<analysis::Type> leftKind) {
+  switch (op) {
   // Numeric Arithmetic
   case lexer::MINUS:
     return emit(op_sub);
@@ -62,16 +89,13 @@ void Compiler::compile_binary_expr(BinaryExpr *expr, shared_ptr<analysis::Scope>
     return emit(op_gteq);
   }
 
-  auto op = expr->operation.kind;
-  auto leftKind = analysis::tc_expr(expr->left, env);
-
   // add and concat
   if (op == lexer::PLUS) {
     if (leftKind->kind == analysis::NUMBER) {
       return emit(op_add);
     }
 
-    emit(op_concat);
+    return emit(op_concat);
   }
 
   TODO("== AND != not implimted at compiler level");
@@ -0,0 +1,50 @@
+#include "../analysis/analsyis.h"
+#include "compiler.h"
+
+using namespace ast;
+using namespace runtime;
+using namespace compiler;
+
+// Code for a stack machine is emitted in post-order, which is exactly the order nodes are stored in, so every node is
+// compiled on its own in a single forward pass. Operands of nodes which compile_expr does not descend into are
+// skipped so both produce the same code.
+void Compiler::compile_flat_exprs(const FlatExprs &exprs, const vector<shared_ptr<analysis::Type>> &types,
+                                  shared_ptr<analysis::Scope> env) {
+  vector<bool> skipped(exprs.size());
+
+  for (NodeIndex i = exprs.size(); i-- > 0;) {
+    if (exprs.kind(i) == ast::LOG_MACRO && !skipped[i]) {
+      std::fill(skipped.begin() + exprs.begins[i], skipped.begin() + i, true);
+    }
+  }
+
+  for (NodeIndex i = 0; i < exprs.size(); i++) {
+    if (skipped[i]) {
+      continue;
+    }
+
+    switch (exprs.kind(i)) {
+    case NUMBER_EXPR:
+      emit(op_push);
+      emit(getConstantAddr(exprs.numbers[exprs.lhs[i]]));
+      continue;
+    case STRING_EXPR:
+      emit(op_push);
+      emit(getConstantAddr(exprs.strings[exprs.lhs[i]]));
+      continue;
+    case SYMBOL_EXPR:
+      compile_symbol(exprs.payloads[i], env);
+      continue;
+    case BINARY_EXPR:
+      compile_binary_op((lexer::TokenKind)exprs.payloads[i], types[exprs.lhs[i]]);
+      continue;
+
+    // Macros
+    case ast::LOG_MACRO:
+      continue;
+    default:
+      std::cout << "Compile::expr() unknown kind: " << exprs.kind(i) << "\n";
+      exit(1);
+    }
+  }
+}
@@ -11,7 +11,9 @@ void Compiler::compile_expr_stmt(ExprStmt *stmt, shared_ptr<analysis::Scope> env
 
 void Compiler::compile_module(ModuleStmt *stmt) {
   depth++;
-  module_name = stmt->name;
+  module_name = utils::intern(stmt->name);
+  globals_base = globals_end;
+  globals_end += stmt->scope->next_slot;
 
   for (const auto &s : stmt->body) {
     compile_stmt(s, stmt->scope);
@@ -20,7 +22,7 @@ void Compiler::compile_module(ModuleStmt *stmt) {
   // Setup Main function and call
   if (stmt->is_entry) {
     emit(op_call); // Jump to the main();
-    emit(chunks_lu[getGlobalName("main")]);
+    emit(chunks_lu[getGlobalKey(utils::intern("main"))]);
   }
 
   depth--;
@@ -37,10 +39,15 @@ void Compiler::compile_block_stmt(BlockStmt *stmt, shared_ptr<analysis::Scope> e
 }
 
 void Compiler::compile_fn_decl_stmt(FnDeclStmt *stmt, shared_ptr<analysis::Scope> env) {
-  auto fnEnv = stmt->body.get()->scope;
-  auto fnBody = stmt->body.get()->body;
+  // A body which was deferred and never called was not built or checked, see Scope::defer_bodies.
+  if (!stmt->body || !stmt->body->scope) {
+    return;
+  }
+
+  auto fnEnv = stmt->body->scope;
+  auto fnBody = stmt->body->body;
 
-  chunks_lu[getGlobalName(stmt->name)] = ip();
+  chunks_lu[getGlobalKey(stmt->name)] = ip();
   // Set Label address for use in other functions and recusrive calls
   scope_enter(fnEnv);
 
@@ -52,22 +59,21 @@ void Compiler::compile_fn_decl_stmt(FnDeclStmt *stmt, shared_ptr<analysis::Scope
 }
 
 void Compiler::compile_var_decl_stmt(VarDeclStmt *stmt, shared_ptr<analysis::Scope> env) {
-  string varname = stmt->varname;
+  utils::SymbolId varname = stmt->varname;
   compile_expr(stmt->value, env);
 
   // Global Variable
   if (depth < 2) {
-    size_t globalAddr = globals_lu.size();
-    globals_lu[getGlobalName(varname)] = globalAddr;
+    size_t globalAddr = globals_base + stmt->slot;
+    globals_lu[getGlobalKey(varname)] = globalAddr; // only names the global in debugBytecode
     emit(op_storeg);
     emit(globalAddr);
     return;
   }
 
   // Variable Declaration
-  size_t offset = env->local_offsets[varname];
   emit(op_storel);
-  emit(offset);
+  emit(stmt->slot);
 }
 
 void Compiler::compile_return_stmt(ReturnStmt *stmt, shared_ptr<analysis::Scope> env) {
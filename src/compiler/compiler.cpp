@@ -5,6 +5,7 @@ using namespace ast;
 
 void Compiler::compile(shared_ptr<ProgramStmt> program, string outpath) {
   depth = 0;
+  globals_end = program->entry->scope->get_global()->next_slot; // the globals of the program come first
 
   for (const auto &mod : program->modules) {
     if (!mod->is_entry) {
@@ -16,41 +17,45 @@ void Compiler::compile(shared_ptr<ProgramStmt> program, string outpath) {
   debugBytecode();
 }
 
-void Compiler::compile_stmt(shared_ptr<Stmt> stmt, shared_ptr<analysis::Scope> env) {
+void Compiler::compile_stmt(Stmt *stmt, shared_ptr<analysis::Scope> env) {
 
   switch (stmt->kind) {
   case MODULE_STMT:
-    return compile_module(static_cast<ModuleStmt *>(stmt.get()));
+    return compile_module(static_cast<ModuleStmt *>(stmt));
   case BLOCK_STMT:
-    return compile_block_stmt(static_cast<BlockStmt *>(stmt.get()), env);
+    return compile_block_stmt(static_cast<BlockStmt *>(stmt), env);
   case VAR_DECL_STMT:
-    return compile_var_decl_stmt(static_cast<VarDeclStmt *>(stmt.get()), env);
+    return compile_var_decl_stmt(static_cast<VarDeclStmt *>(stmt), env);
   case FN_DECL_STMT:
-    return compile_fn_decl_stmt(static_cast<FnDeclStmt *>(stmt.get()), env);
+    return compile_fn_decl_stmt(static_cast<FnDeclStmt *>(stmt), env);
   case EXPR_STMT:
-    return compile_expr_stmt(static_cast<ExprStmt *>(stmt.get()), env);
+    return compile_expr_stmt(static_cast<ExprStmt *>(stmt), env);
   case RETURN_STMT:
-    return compile_return_stmt(static_cast<ReturnStmt *>(stmt.get()), env);
+    return compile_return_stmt(static_cast<ReturnStmt *>(stmt), env);
+  case IMPORT_STMT:
+    return; // imported modules are compiled on their own by compile()
+  case STRUCT_STMT:
+    return; // structs only declare a type, which analysis already resolved
   }
 
   std::cout << "Compile::stmt() unknown kind: " << stmt->kind << "\n";
   exit(1);
 }
 
-void Compiler::compile_expr(shared_ptr<Expr> expr, shared_ptr<analysis::Scope> env) {
+void Compiler::compile_expr(Expr *expr, shared_ptr<analysis::Scope> env) {
   switch (expr->kind) {
   case NUMBER_EXPR:
-    return compile_number_expr(static_cast<NumberExpr *>(expr.get()), env);
+    return compile_number_expr(static_cast<NumberExpr *>(expr), env);
   case STRING_EXPR:
-    return compile_string_expr(static_cast<StringExpr *>(expr.get()), env);
+    return compile_string_expr(static_cast<StringExpr *>(expr), env);
   case SYMBOL_EXPR:
-    return compile_symbol_expr(static_cast<SymbolExpr *>(expr.get()), env);
+    return compile_symbol_expr(static_cast<SymbolExpr *>(expr));
   case BINARY_EXPR:
-    return compile_binary_expr(static_cast<BinaryExpr *>(expr.get()), env);
+    return compile_binary_expr(static_cast<BinaryExpr *>(expr), env);
 
   // Macros
   case LOG_MACRO:
-    return compile_log_macro(static_cast<LogMacro *>(expr.get()), env);
+    return compile_log_macro(static_cast<LogMacro *>(expr), env);
   }
 
   std::cout << "Compile::expr() unknown kind: " << expr->kind << "\n";
@@ -103,8 +108,6 @@ void Compiler::debugBytecode() {
   using std::cout, std::hex;
   using namespace runtime;
   cout << "\n-----------------------------------------\n" << instructions << "\n\n";
-  using std::cout;
-  using namespace runtime;
 
   // Data section
   cout << "\n.data:\n";
@@ -127,9 +130,9 @@ void Compiler::debugBytecode() {
   // Constants Section
   cout << "\n.globals:\n";
 
-  for (const auto &[varname, addr] : globals_lu) {
+  for (const auto &[key, addr] : globals_lu) {
     printf("%03lu  ", addr);
-    std::cout << varname << "\n";
+    std::cout << getGlobalName(key) << "\n";
   }
 
   // Instructions
@@ -160,7 +163,7 @@ void Compiler::debugBytecode() {
       cout << "(storel) store_local " << code[ip++];
       break;
     case op_incsp:
-      cout << "(incsp) incriment_stack_pointer " << code[ip] << "\n";
+      cout << "(incsp) incriment_stack_pointer " << code[ip++] << "\n";
       break;
     case op_decsp:
       cout << "(decsp) decrement_stack_pointer " << code[ip++] << "\n";
@@ -203,9 +206,11 @@ void Compiler::debugBytecode() {
   cout << "\n-----------------------------------------\n";
 }
 
+// Blocks share the frame of their function. The function reserves the slots of every block inside it at once, except
+// for the parameters which the caller pushed.
 void Compiler::scope_enter(shared_ptr<analysis::Scope> env) {
   depth++;
-  auto numLocals = env->local_offsets.size();
+  auto numLocals = env->is_function ? env->frame_size - env->params : 0;
 
   // Setup Space for Locals
   if (numLocals > 0) {
@@ -215,7 +220,7 @@ void Compiler::scope_enter(shared_ptr<analysis::Scope> env) {
 }
 
 void Compiler::scope_exit(shared_ptr<analysis::Scope> env) {
-  auto numLocals = env->local_offsets.size();
+  auto numLocals = env->is_function ? env->frame_size - env->params : 0;
 
   // Setup Space for Locals
   if (numLocals > 0) {
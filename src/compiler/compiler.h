@@ -3,6 +3,7 @@
 #include "../ast/ast_expr.h"
 #include "../ast/ast_macro.h"
 #include "../ast/ast_stmt.h"
+#include "../ast/flat.h"
 #include "../bedrock.h"
 #include "../instructions/opcodes.h"
 #include "../vm/values.h"
@@ -15,19 +16,26 @@
 
 namespace compiler {
 
+/// @brief Key of a module level name. The interned module name sits in the upper 32 bits and the interned variable or
+/// fn name in the lower 32 bits.
+typedef uint64_t GlobalKey;
+
 struct Compiler {
-  size_t depth;                             // 0 means global, 1 means module, 2+ means inside a local-scope.
-  unordered_map<string, size_t> globals_lu; // Contains the offset for the globals pool for a given variable name.
-  unordered_map<string, size_t> chunks_lu;  // Contains a mapping from fn_name to chunk_address in the ip
+  size_t depth;                                // 0 means global, 1 means module, 2+ means inside a local-scope.
+  unordered_map<GlobalKey, size_t> globals_lu; // Contains the offset for the globals pool for a given variable name.
+  unordered_map<GlobalKey, size_t> chunks_lu;  // Contains a mapping from fn_name to chunk_address in the ip
+
+  size_t globals_base = 0; // address of the first global of the module being compiled
+  size_t globals_end = 0;  // first address after the globals of every module compiled so far
 
   vector<runtime::Val> data;
   vector<u_int16_t> code;
-  string module_name; // Name of current module
+  utils::SymbolId module_name; // Interned name of current module
 
   void compile(shared_ptr<ast::ProgramStmt> program, string outpath);
 
-  void compile_expr(shared_ptr<ast::Expr>, shared_ptr<analysis::Scope>);
-  void compile_stmt(shared_ptr<ast::Stmt>, shared_ptr<analysis::Scope>);
+  void compile_expr(ast::Expr *, shared_ptr<analysis::Scope>);
+  void compile_stmt(ast::Stmt *, shared_ptr<analysis::Scope>);
 
   // Statements
   void compile_module(ast::ModuleStmt *);
@@ -40,8 +48,17 @@ struct Compiler {
   // Expressions
   void compile_number_expr(ast::NumberExpr *, shared_ptr<analysis::Scope>);
   void compile_string_expr(ast::StringExpr *, shared_ptr<analysis::Scope>);
-  void compile_symbol_expr(ast::SymbolExpr *, shared_ptr<analysis::Scope>);
+  void compile_symbol_expr(ast::SymbolExpr *);
   void compile_binary_expr(ast::BinaryExpr *, shared_ptr<analysis::Scope>);
+  void compile_symbol(utils::SymbolId, shared_ptr<analysis::Scope>);
+  void compile_binding(const analysis::Binding &, utils::SymbolId);
+  void compile_binary_op(lexer::TokenKind, shared_ptr<analysis::Type> leftKind);
+
+  // Flat AST
+  /// @brief Compiles every expression in exprs, in order. types holds the type of each node, see
+  /// analysis::tc_flat_exprs.
+  void compile_flat_exprs(const ast::FlatExprs &, const vector<shared_ptr<analysis::Type>> &types,
+                          shared_ptr<analysis::Scope>);
 
   void scope_enter(shared_ptr<analysis::Scope>);
   void scope_exit(shared_ptr<analysis::Scope>);
@@ -62,15 +79,20 @@ struct Compiler {
     code.push_back(byte);
   }
 
+  // Pairs the current module with a variable/fn name
+  GlobalKey getGlobalKey(utils::SymbolId name) {
+    return (GlobalKey)module_name << 32 | name;
+  }
+
   // Prepends ModuleName along with variable/fn name
-  string getGlobalName(string name) {
-    return "(" + module_name + ") " + name;
+  string getGlobalName(GlobalKey key) {
+    return "(" + utils::symbol_name(key >> 32) + ") " + utils::symbol_name((utils::SymbolId)key);
   }
 
   string getGlobalFromAddr(size_t addr) {
-    for (const auto &[varname, address] : globals_lu) {
+    for (const auto &[key, address] : globals_lu) {
       if (addr == address) {
-        return varname;
+        return getGlobalName(key);
       }
     }
 
@@ -79,9 +101,9 @@ struct Compiler {
   }
 
   string getChunkFromAddr(size_t addr) {
-    for (const auto &[varname, address] : chunks_lu) {
+    for (const auto &[key, address] : chunks_lu) {
       if (addr == address) {
-        return varname;
+        return getGlobalName(key);
       }
     }
 
@@ -56,9 +56,9 @@ string Err::str() {
 
   err += bold_red("Error") + "::" + bold_white(error_kind(this->kind)) + "\n";
 
-  // TODO: Impliment code snippet view
   if (this->loc) {
     err += bold_blue(" .Location") + ": " + this->loc->error_str() + "\n";
+    err += this->loc->get_snippet(true, 1);
   }
 
   err += bold_magenta(" .Message") + ": " + this->msg + "\n";
@@ -1,20 +1,67 @@
 #pragma once
 
+#include <mutex>
+
 #include "includes.h"
 
 // Forward Declarations
 namespace lexer {
+/// @brief A source file loaded into memory. Regular files are memory mapped and read in place. Pipes and other
+/// unmappable files fall back to a buffered read. contents is a view into whichever of the two backs the file.
 struct SourceFile {
   string file_path;
-  string contents;
+  string_view contents;
+
+  /// @brief Loads the file at file_path. Returns nullptr when the file cannot be opened or read.
+  static shared_ptr<SourceFile> open(const string &file_path);
+  /// @brief Creates a SourceFile which owns a copy of contents instead of reading from disk.
+  static shared_ptr<SourceFile> from_string(const string &file_path, string contents);
+
+  bool is_mapped() const {
+    return mapping != nullptr;
+  }
+
+  /// @brief Returns the 1 based line containing the byte at offset. The first call builds the line index, later calls
+  /// are a binary search over it.
+  size_t line_of(size_t offset);
+  /// @brief Returns the 1 based column of the byte at offset, counted in bytes.
+  size_t column_of(size_t offset);
+  /// @brief Returns the text of a 1 based line without its line terminator.
+  string_view line_text(size_t line);
+  size_t line_count();
+
+  SourceFile() {
+  }
+  SourceFile(const SourceFile &) = delete;
+  SourceFile &operator=(const SourceFile &) = delete;
+  ~SourceFile();
+
+private:
+  void *mapping = nullptr;
+  size_t mapping_size = 0;
+  string buffer;
+
+  // Offset of the first byte of every line. Built once on demand since only diagnostics need it.
+  std::once_flag line_index_built;
+  vector<uint32_t> line_index;
+  const vector<uint32_t> &lines();
 };
 
+/// @brief A byte range inside a SourceFile. Line and column are not stored, they are resolved through the file's line
+/// index when a diagnostic is rendered.
 struct SourcePos {
   shared_ptr<SourceFile> file;
-  size_t line;
   size_t start;
   size_t end;
 
+  size_t line() const {
+    return file->line_of(start);
+  }
+
+  size_t column() const {
+    return file->column_of(start);
+  }
+
   /// @brief Returns a string representation used for error reporting.
   /// Format: (/path/to/file/filename.br)[line:start:end]
   string error_str();
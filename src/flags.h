@@ -15,6 +15,9 @@ extern bool DISPLAY_AST;
 /// finished. Defaults to false.
 extern bool DISPLAY_TOKENS;
 
+/// @brief Whether --ast and --tokens are dumped as newline delimited JSON instead of colored text. Defaults to false.
+extern bool DUMP_JSON;
+
 /// @brief Whether or not to display a typeinfo & scope information after static
 /// analysis is completed.
 extern bool DISPLAY_TYPEINFO;
@@ -22,5 +25,13 @@ extern bool DISPLAY_TYPEINFO;
 /// @brief Instructs compiler to disable bound checking on slices & strings.
 extern bool DISABLE_BOUND_CHECKING;
 
+/// @brief Whether function bodies are only brace matched while parsing and built the first time they are needed.
+/// Defaults to false.
+extern bool LAZY_FN_BODIES;
+
+/// @brief Whether parsed modules and their interface summaries are stored in COMPILED_FILES_PATH and loaded from there
+/// while their source is unchanged. Defaults to true.
+extern bool AST_CACHE;
+
 /// @brief Path to compiled c/header files.
 extern std::string COMPILED_FILES_PATH;
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -20,6 +21,7 @@ using std::pair;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::unordered_map;
 using std::vector;
\ No newline at end of file
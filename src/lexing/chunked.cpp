@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstring>
+
+#include "lexer.h"
+
+using namespace lexer;
+
+// Splitting a file is only safe between tokens, which cannot be known without lexing everything before the split.
+// Chunks therefore start right after a newline and are lexed speculatively. While stitching, a chunk is accepted as
+// soon as the sequential position lands on a token the chunk also produced. The scanner keeps no state besides its
+// position, so from that token on both produce exactly the same stream. A chunk which started inside a string or
+// comment is re-lexed sequentially until the two line up again, which in practice is within a line or two.
+
+namespace {
+struct Chunk {
+  size_t start;
+  size_t stop; // start of the next chunk
+  TokenBuffer tokens;
+  vector<errors::Err> errs;
+  size_t end; // position the chunk's lexer stopped at. Always >= stop unless it failed.
+};
+
+vector<size_t> chunk_starts(string_view src, size_t chunk_count) {
+  vector<size_t> starts = {0};
+
+  for (size_t i = 1; i < chunk_count; i++) {
+    size_t target = std::max(starts.back() + 1, src.length() / chunk_count * i);
+    if (target >= src.length()) {
+      break;
+    }
+
+    auto newline = (const char *)memchr(src.data() + target, '\n', src.length() - target);
+    if (newline == nullptr || newline + 1 == src.data() + src.length()) {
+      break;
+    }
+
+    starts.push_back(newline + 1 - src.data());
+  }
+
+  return starts;
+}
+}; // namespace
+
+pair<TokenBuffer, vector<errors::Err>> lexer::tokenize_chunked(shared_ptr<SourceFile> file, utils::ThreadPool &pool,
+                                                               size_t chunk_count) {
+  auto starts = chunk_starts(file->contents, std::max<size_t>(chunk_count, 1));
+  vector<std::future<Chunk>> pending;
+
+  for (size_t i = 0; i < starts.size(); i++) {
+    size_t start = starts[i];
+    size_t stop = i + 1 < starts.size() ? starts[i + 1] : file->contents.length();
+
+    pending.push_back(pool.submit([file, start, stop]() {
+      Lexer lex{file};
+      lex.pos = start;
+      lex.scan_until(stop);
+      return Chunk{start, stop, std::move(lex.tokens), std::move(lex.errs), lex.pos};
+    }));
+  }
+
+  TokenBuffer tokens;
+  tokens.file = file;
+  vector<errors::Err> errs;
+  size_t pos = 0; // where sequential lexing would continue from
+
+  for (auto &future : pending) {
+    Chunk chunk = future.get();
+
+    // A previous chunk failed, so sequential lexing would have stopped there.
+    if (errs.size() > 0) {
+      continue;
+    }
+
+    // The previous chunk ended exactly where this one starts so this chunk is already what sequential lexing produces.
+    if (pos == chunk.start) {
+      tokens.append(chunk.tokens);
+      errs = std::move(chunk.errs);
+      pos = chunk.end;
+      continue;
+    }
+
+    // A token of the previous chunk ran past this chunk's start. Lex sequentially until a token lines up.
+    Lexer lex{file};
+    lex.pos = pos;
+    bool synced = false;
+
+    while (!synced && lex.pos < chunk.stop && !lex.at_eof() && lex.errs.size() == 0) {
+      size_t before = lex.tokens.size();
+      lex.scan_token();
+
+      if (lex.tokens.size() == before) {
+        continue; // whitespace or a comment
+      }
+
+      uint32_t offset = lex.tokens.offsets.back();
+      auto it = std::lower_bound(chunk.tokens.offsets.begin(), chunk.tokens.offsets.end(), offset);
+
+      if (it != chunk.tokens.offsets.end() && *it == offset) {
+        lex.tokens.pop();
+        tokens.append(lex.tokens);
+        tokens.append(chunk.tokens, it - chunk.tokens.offsets.begin());
+        errs = std::move(chunk.errs);
+        pos = chunk.end;
+        synced = true;
+      }
+    }
+
+    if (!synced) {
+      tokens.append(lex.tokens);
+      errs = std::move(lex.errs);
+      pos = lex.pos;
+    }
+  }
+
+  tokens.push(END_FILE, pos, 0);
+  return make_pair(std::move(tokens), errs);
+}
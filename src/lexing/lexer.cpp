@@ -1,22 +1,29 @@
 #include "lexer.h"
 
-#include <regex>
-
 #include "../util/utils.h"
+#include "scan.h"
 
-using std::regex;
-using std::smatch;
 using namespace lexer;
 
+static bool is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool is_symbol_start(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '@';
+}
+
 lexer::Lexer::Lexer(string file_path) {
   pos = 0;
-  line = 1;
-  tokens = std::vector<Token>();
-  file = make_shared<SourceFile>();
-  file->file_path = file_path;
-  auto contents = utils::read_file_contents(file_path);
+  file = SourceFile::open(file_path);
 
-  if (!contents.has_value()) {
+  if (!file) {
+    file = SourceFile::from_string(file_path, "");
+    tokens.file = file;
     errs.push_back(Err(ErrKind::InvalidFilePath)
                        .message("Attempted but failed to read file: " + bold_white(file_path))
                        .hint("Verify a bedrock file exists at this location."));
@@ -24,169 +31,307 @@ lexer::Lexer::Lexer(string file_path) {
     return;
   }
 
-  file->contents = contents.value();
-
-  using lexer::TokenKind;
-  // TODO: Cleanup regex pattern using macro?
-  patterns = {
-      {regex(R"(\s+)"), skip_handler},
-      {regex(R"(\/\/.*)"), comment_handler},
-      {regex(R"("[^"]*")"), string_handler},
-      {regex(R"([0-9]+(\.[0-9]+)?)"), number_handler},
-      {regex(R"([a-zA-Z_@][a-zA-Z0-9_]*)"), symbol_handler},
-      {regex(R"(\[)"), default_handler(OPEN_BRACKET, "[")},
-      {regex(R"(\])"), default_handler(CLOSE_BRACKET, "]")},
-      {regex(R"(\{)"), default_handler(OPEN_CURLY, "{")},
-      {regex(R"(\})"), default_handler(CLOSE_CURLY, "}")},
-      {regex(R"(\()"), default_handler(OPEN_PAREN, "(")},
-      {regex(R"(\))"), default_handler(CLOSE_PAREN, ")")},
-      {regex(R"(\=\=)"), default_handler(EQUALS, "==")},
-      {regex(R"(\!\=)"), default_handler(NOT_EQUALS, "!=")},
-      {regex(R"(!)"), default_handler(NOT, "!")},
-      {regex(R"(=)"), default_handler(ASSIGNMENT, "=")},
-      {regex(R"(->)"), default_handler(ARROW, "->")},
-      {regex(R"(<)"), default_handler(OPEN_GENERIC, "<")},
-      {regex(R"(>)"), default_handler(CLOSE_GENERIC, ">")},
-      {regex(R"(\.\.)"), default_handler(DOT_DOT, "..")},
-      {regex(R"(\.)"), default_handler(DOT, ".")},
-      {regex(R"(;)"), default_handler(SEMICOLON, ";")},
-      {regex(R"(::)"), default_handler(COLON_COLON, "::")},
-      {regex(R"(:)"), default_handler(COLON, ":")},
-      {regex(R"(\?)"), default_handler(QUESTION, "?")},
-      {regex(R"(,)"), default_handler(COMMA, ",")},
-      {regex(R"(\+\+)"), default_handler(PLUS_PLUS, "++")},
-      {regex(R"(--)"), default_handler(MINUS_MINUS, "--")},
-      {regex(R"(\+=)"), default_handler(PLUS_EQUALS, "+=")},
-      {regex(R"(-=)"), default_handler(MINUS_EQUALS, "-=")},
-      {regex(R"(/=)"), default_handler(SLASH_EQUALS, "/=")},
-      {regex(R"(\*=)"), default_handler(STAR_EQUALS, "*=")},
-      {regex(R"(\+)"), default_handler(PLUS, "+")},
-      {regex(R"(-)"), default_handler(MINUS, "-")},
-      {regex(R"(/)"), default_handler(SLASH, "/")},
-      {regex(R"(\*)"), default_handler(STAR, "*")},
-      {regex(R"(%)"), default_handler(PERCENT, "%")},
-      {regex(R"(&)"), default_handler(AMPERSAND, "&")},
-  };
+  *this = Lexer(file);
 };
 
-pair<vector<Token>, vector<errors::Err>> lexer::tokenize(string file_path) {
+lexer::Lexer::Lexer(shared_ptr<SourceFile> source) {
+  pos = 0;
+  file = source;
+  tokens.file = file;
+
+  // Token offsets and lengths are stored as 32 bit integers.
+  if (file->contents.length() >= UINT32_MAX) {
+    errs.push_back(Err(ErrKind::Fatal)
+                       .message("Source file is too large to compile: " + bold_white(file->file_path))
+                       .hint("Bedrock source files must be smaller than 4GB."));
+  }
+}
+
+pair<TokenBuffer, vector<errors::Err>> lexer::tokenize(string file_path) {
   Lexer lex{file_path};
 
   // Means loading the file produces errors.
   if (lex.errs.size() != 0) {
-    return make_pair(lex.tokens, lex.errs);
+    return make_pair(std::move(lex.tokens), lex.errs);
+  }
+
+  auto &pool = utils::thread_pool();
+  if (lex.file->contents.length() >= PARALLEL_LEXING_THRESHOLD && pool.size() > 1) {
+    return tokenize_chunked(lex.file, pool, pool.size() * 4);
+  }
+
+  lex.scan_until(SIZE_MAX);
+  lex.push(TokenKind::END_FILE, lex.pos, lex.pos);
+
+  return make_pair(std::move(lex.tokens), lex.errs);
+}
+
+void lexer::Lexer::scan_until(size_t stop) {
+  while (pos < stop && !at_eof() && errs.size() == 0) {
+    scan_token();
+  }
+}
+
+void lexer::Lexer::scan_token() {
+  char c = at(0);
+
+  if (is_whitespace(c)) {
+    return skip_handler(*this);
+  }
+
+  if (is_digit(c)) {
+    return number_handler(*this);
   }
 
-  while (!lex.at_eof() && lex.errs.size() == 0) {
-    bool matched = false;
+  if (is_symbol_start(c)) {
+    return symbol_handler(*this);
+  }
 
-    for (const auto &pattern : lex.patterns) {
-      smatch match;
-      string remainder = lex.remainder();
-      if (regex_search(remainder, match, pattern.re) && match.position() == 0) {
-        pattern.handler(lex, pattern.re);
-        matched = true;
-        break; // Exit the loop after the first match
-      }
+  switch (c) {
+  case '"':
+    return string_handler(*this);
+  case '/':
+    if (at(1) == '/') {
+      return comment_handler(*this);
     }
 
-    if (!matched) {
-      SourcePos pos{lex.file, lex.line, lex.pos, lex.pos};
-      lex.errs.push_back(
-          Err(ErrKind::UnexpectedToken)
-              .message(bold_white("Unrecognized token near " + pos.error_str()) + "  " + lex.remainder()));
+    if (at(1) == '=') {
+      return default_handler(*this, SLASH_EQUALS, 2);
     }
-  }
 
-  SourcePos pos{lex.file, lex.line, lex.pos, lex.pos};
-  lex.push(Token{pos, TokenKind::END_FILE, "EOF"});
+    return default_handler(*this, SLASH, 1);
+  case '[':
+    return default_handler(*this, OPEN_BRACKET, 1);
+  case ']':
+    return default_handler(*this, CLOSE_BRACKET, 1);
+  case '{':
+    return default_handler(*this, OPEN_CURLY, 1);
+  case '}':
+    return default_handler(*this, CLOSE_CURLY, 1);
+  case '(':
+    return default_handler(*this, OPEN_PAREN, 1);
+  case ')':
+    return default_handler(*this, CLOSE_PAREN, 1);
+  case '=':
+    if (at(1) == '=') {
+      return default_handler(*this, EQUALS, 2);
+    }
 
-  return make_pair(lex.tokens, lex.errs);
-}
+    return default_handler(*this, ASSIGNMENT, 1);
+  case '!':
+    if (at(1) == '=') {
+      return default_handler(*this, NOT_EQUALS, 2);
+    }
 
-regex_handler lexer::default_handler(TokenKind kind, const string &value) {
-  return [kind, value](Lexer &lex, const regex &) {
-    SourcePos pos{lex.file, lex.line, lex.pos, 0};
-    lex.advance_n(value.length());
-    pos.end = lex.pos;
-    lex.push(Token{pos, kind, value});
-  };
-}
+    return default_handler(*this, NOT, 1);
+  case '-':
+    if (at(1) == '>') {
+      return default_handler(*this, ARROW, 2);
+    }
+
+    if (at(1) == '-') {
+      return default_handler(*this, MINUS_MINUS, 2);
+    }
+
+    if (at(1) == '=') {
+      return default_handler(*this, MINUS_EQUALS, 2);
+    }
+
+    return default_handler(*this, MINUS, 1);
+  case '+':
+    if (at(1) == '+') {
+      return default_handler(*this, PLUS_PLUS, 2);
+    }
+
+    if (at(1) == '=') {
+      return default_handler(*this, PLUS_EQUALS, 2);
+    }
+
+    return default_handler(*this, PLUS, 1);
+  case '*':
+    if (at(1) == '=') {
+      return default_handler(*this, STAR_EQUALS, 2);
+    }
+
+    return default_handler(*this, STAR, 1);
+  case '<':
+    return default_handler(*this, OPEN_GENERIC, 1);
+  case '>':
+    return default_handler(*this, CLOSE_GENERIC, 1);
+  case '.':
+    if (at(1) == '.') {
+      return default_handler(*this, DOT_DOT, 2);
+    }
 
-void lexer::string_handler(Lexer &lex, const regex &re) {
-  smatch match;
-  string remainder = lex.remainder();
+    return default_handler(*this, DOT, 1);
+  case ':':
+    if (at(1) == ':') {
+      return default_handler(*this, COLON_COLON, 2);
+    }
 
-  if (regex_search(remainder, match, re)) {
-    string literal = match.str().substr(1, match.str().length() - 2);
-    SourcePos pos{lex.file, lex.line, lex.pos, 0};
-    lex.advance_n(match.str().length());
-    pos.end = lex.pos;
-    lex.push(Token{pos, TokenKind::STRING, literal});
+    return default_handler(*this, COLON, 1);
+  case ';':
+    return default_handler(*this, SEMICOLON, 1);
+  case '?':
+    return default_handler(*this, QUESTION, 1);
+  case ',':
+    return default_handler(*this, COMMA, 1);
+  case '%':
+    return default_handler(*this, PERCENT, 1);
+  case '&':
+    return default_handler(*this, AMPERSAND, 1);
   }
+
+  SourcePos pos{file, this->pos, this->pos};
+  errs.push_back(Err(ErrKind::UnexpectedToken)
+                     .message(bold_white("Unrecognized token near " + pos.error_str()) + "  " + string(1, c))
+                     .location(make_shared<SourcePos>(pos)));
+}
+
+void lexer::default_handler(Lexer &lex, TokenKind kind, size_t length) {
+  lex.push(kind, lex.pos, lex.pos + length);
+  lex.advance_n(length);
 }
 
-void lexer::number_handler(Lexer &lex, const regex &re) {
-  smatch match;
-  string remainder = lex.remainder();
+void lexer::string_handler(Lexer &lex) {
+  string_view src = lex.file->contents;
+  size_t start = lex.pos;
+  size_t end = scan::find_quote(src.data() + start + 1, src.data() + src.length()) - src.data();
 
-  if (regex_search(remainder, match, re)) {
-    SourcePos pos{lex.file, lex.line, lex.pos, 0};
-    lex.advance_n(match.str().length());
-    pos.end = lex.pos;
-    lex.push(Token{pos, TokenKind::NUMBER, match.str()});
+  if (end >= src.length()) {
+    SourcePos pos{lex.file, start, end};
+    lex.errs.push_back(Err(ErrKind::MissingStringTermination)
+                           .message("Unterminated string literal near " + pos.error_str())
+                           .hint("Add a closing \" to the end of the string.")
+                           .location(make_shared<SourcePos>(pos)));
+    lex.pos = end;
+    return;
   }
+
+  lex.push(TokenKind::STRING, start, end + 1);
+  lex.pos = end + 1;
 }
 
-void lexer::symbol_handler(Lexer &lex, const regex &re) {
-  smatch match;
-  string remainder = lex.remainder();
+void lexer::number_handler(Lexer &lex) {
+  string_view src = lex.file->contents;
+  size_t end = lex.pos;
 
-  if (regex_search(remainder, match, re)) {
-    string symbol = match.str();
-    SourcePos pos{lex.file, lex.line, lex.pos, 0};
+  while (end < src.length() && is_digit(src[end])) {
+    end++;
+  }
 
-    lex.advance_n(symbol.length());
-    pos.end = lex.pos;
+  // Only consume the '.' when digits follow it. `1.` lexes as NUMBER DOT.
+  if (end + 1 < src.length() && src[end] == '.' && is_digit(src[end + 1])) {
+    end++;
 
-    auto it = reserved_lu.find(symbol);
-    if (it != reserved_lu.end()) {
-      lex.push(Token{pos, it->second, symbol});
-    } else {
-      lex.push(Token{pos, TokenKind::IDENTIFIER, symbol});
+    while (end < src.length() && is_digit(src[end])) {
+      end++;
     }
   }
+
+  lex.push(TokenKind::NUMBER, lex.pos, end);
+  lex.pos = end;
 }
 
-void lexer::skip_handler(Lexer &lex, const regex &re) {
-  smatch match;
-  string remainder = lex.remainder();
-  if (regex_search(remainder, match, re)) {
-    string matched = match.str();
-    size_t new_lines = count(matched.begin(), matched.end(), '\n');
-    lex.advance_n(match.length());
-    lex.line += new_lines;
-  }
+void lexer::symbol_handler(Lexer &lex) {
+  string_view src = lex.file->contents;
+  size_t end = scan::skip_identifier(src.data() + lex.pos + 1, src.data() + src.length()) - src.data();
+
+  string_view word = src.substr(lex.pos, end - lex.pos);
+  TokenKind kind = reserved_kind(word);
+
+  // Identifiers are interned here, once, so every later stage compares names as integers.
+  lex.push(kind, lex.pos, end, kind == IDENTIFIER ? utils::intern(word) : 0);
+  lex.pos = end;
 }
 
-void lexer::comment_handler(Lexer &lex, const regex &re) {
-  smatch match;
-  string remainder = lex.remainder();
-  if (regex_search(remainder, match, re)) {
-    lex.advance_n(match.length());
-    lex.line++;
-  }
+void lexer::skip_handler(Lexer &lex) {
+  string_view src = lex.file->contents;
+  lex.pos = scan::skip_whitespace(src.data() + lex.pos, src.data() + src.length()) - src.data();
+}
+
+// Consumes everything up to but not including the line terminator, which is left for skip_handler.
+void lexer::comment_handler(Lexer &lex) {
+  string_view src = lex.file->contents;
+  lex.pos = scan::find_line_end(src.data() + lex.pos, src.data() + src.length()) - src.data();
 }
 
 void Lexer::advance_n(size_t n) {
   pos += n;
 }
-void Lexer::push(Token token) {
-  tokens.push_back(token);
+void Lexer::push(TokenKind kind, size_t start, size_t end, utils::SymbolId symbol) {
+  tokens.push(kind, start, end - start, symbol);
 }
 bool Lexer::at_eof() {
   return pos >= file->contents.length();
 }
-string Lexer::remainder() {
-  return file->contents.substr(pos);
-}
\ No newline at end of file
+char Lexer::at(size_t offset) {
+  return pos + offset < file->contents.length() ? file->contents[pos + offset] : '\0';
+}
+
+lexer::TokenStream::TokenStream(string file_path) : buffer(nullptr) {
+  lex.emplace(file_path);
+  file = lex->file;
+  errs = lex->errs;
+}
+
+lexer::TokenStream::TokenStream(const TokenBuffer &buffer) : file(buffer.file), buffer(&buffer) {
+}
+
+const Token &lexer::TokenStream::peek(size_t n) {
+  if (count <= n) {
+    fill(n);
+  }
+
+  return ring[(head + n) & (LOOKAHEAD - 1)];
+}
+
+Token lexer::TokenStream::advance() {
+  Token tk = peek(0);
+
+  // END_FILE stays in place so peeking past the end keeps returning it.
+  if (tk.kind != END_FILE) {
+    head = (head + 1) & (LOOKAHEAD - 1);
+    count--;
+  }
+
+  return tk;
+}
+
+shared_ptr<SourcePos> lexer::TokenStream::pos(const Token &tk) const {
+  return make_shared<SourcePos>(SourcePos{file, tk.offset, (size_t)tk.offset + tk.length});
+}
+
+// Scans until the ring holds n + 1 tokens. The lexer pushes into its own TokenBuffer, which is drained into the ring
+// after every call so it never holds more than a token or two. In buffer mode tokens are copied over from the buffer
+// instead, so peek can hand out references in both modes.
+void lexer::TokenStream::fill(size_t n) {
+  while (count <= n) {
+    if (count > 0 && ring[(head + count - 1) & (LOOKAHEAD - 1)].kind == END_FILE) {
+      ring[(head + count) & (LOOKAHEAD - 1)] = ring[(head + count - 1) & (LOOKAHEAD - 1)];
+      count++;
+      continue;
+    }
+
+    if (buffer) {
+      ring[(head + count++) & (LOOKAHEAD - 1)] = buffer->at(index);
+      index += index + 1 < buffer->size();
+      continue;
+    }
+
+    Lexer &l = *lex;
+
+    if (l.at_eof() || l.errs.size() > 0) {
+      l.push(END_FILE, l.pos, l.pos);
+      errs = l.errs;
+    } else {
+      l.scan_token();
+    }
+
+    for (size_t i = 0; i < l.tokens.size(); i++) {
+      ring[(head + count++) & (LOOKAHEAD - 1)] = l.tokens.at(i);
+    }
+
+    l.tokens.clear();
+  }
+}
@@ -1,46 +1,99 @@
 #pragma once
 
-#include <functional>
-#include <regex>
+#include <array>
 
 #include "../bedrock.h"
+#include "../util/thread_pool.h"
 #include "token.h"
 
-using std::function;
-using std::regex;
-
 namespace lexer {
 
-struct Lexer;
-
-typedef function<void(Lexer &, const regex &)> regex_handler;
+/// @brief Files at least this large are split into chunks and lexed on the shared thread pool.
+const size_t PARALLEL_LEXING_THRESHOLD = 4 * 1024 * 1024;
 
-struct regex_pattern {
-  regex re;
-  regex_handler handler;
+/// @brief A change to a source file. `removed` bytes starting at `offset` were replaced with `inserted`.
+struct Edit {
+  size_t offset;
+  size_t removed;
+  string inserted;
 };
 
-pair<vector<Token>, vector<errors::Err>> tokenize(string file_path);
+pair<TokenBuffer, vector<errors::Err>> tokenize(string file_path);
+/// @brief Returns a copy of file with edit applied.
+shared_ptr<SourceFile> apply_edit(const SourceFile &file, const Edit &edit);
+/// @brief Updates the tokens of a file after an edit, see Lexer::relex. edited is the file with the edit applied.
+pair<TokenBuffer, vector<errors::Err>> relex(TokenBuffer previous, shared_ptr<SourceFile> edited, const Edit &edit);
+/// @brief Lexes file as chunk_count pieces on pool. Chunks start after a newline and are lexed independently, then
+/// stitched back together so the output is identical to lexing the file sequentially.
+pair<TokenBuffer, vector<errors::Err>> tokenize_chunked(shared_ptr<SourceFile> file, utils::ThreadPool &pool,
+                                                        size_t chunk_count);
 
+/// @brief Single pass scanner which works directly on the source buffer. Each call to scan_token() dispatches on the
+/// current character and consumes exactly one token, comment or run of whitespace.
 struct Lexer {
   size_t pos;
-  size_t line;
-  vector<Token> tokens;
+  TokenBuffer tokens;
   shared_ptr<SourceFile> file;
   vector<errors::Err> errs;
-  vector<regex_pattern> patterns;
 
   Lexer(string file_path);
+  Lexer(shared_ptr<SourceFile> file);
+  void scan_token();
+  /// @brief Scans tokens until pos reaches stop, the end of the file or an error. The last token may end past stop.
+  void scan_until(size_t stop);
+  /// @brief Rebuilds tokens for this lexer's file, which is the file `previous` was lexed from with edit applied.
+  /// Tokens which end well before the edit are kept, lexing restarts after the last of them and stops as soon as it
+  /// produces a token which also exists in previous past the edit. Tokens from there on are reused with their offsets
+  /// shifted by the change in length.
+  void relex(TokenBuffer previous, const Edit &edit);
   void advance_n(size_t n);
-  void push(Token token);
+  /// @brief Appends a token spanning [start, end).
+  void push(TokenKind kind, size_t start, size_t end, utils::SymbolId symbol = 0);
   bool at_eof();
-  string remainder();
+  /// @brief Returns the character `offset` bytes ahead of pos or '\0' when past the end of the file.
+  char at(size_t offset);
+};
+
+/// @brief Pull based token source for the parser. In streaming mode tokens are scanned on demand into a small ring
+/// buffer, so memory stays bounded no matter how large the file is. A stream can also wrap an already lexed
+/// TokenBuffer, which is what --tokens uses since it needs the whole stream up front.
+///
+/// Once the source is exhausted, or the lexer reports an error, every further token is END_FILE. Lexing errors are
+/// left in errs for the caller to report.
+struct TokenStream {
+  static const size_t LOOKAHEAD = 8; // must be a power of two
+
+  shared_ptr<SourceFile> file;
+  vector<errors::Err> errs;
+
+  /// @brief Streams tokens from the file at file_path as they are requested.
+  TokenStream(string file_path);
+  /// @brief Reads tokens from a buffer lexed up front. The buffer must outlive the stream.
+  TokenStream(const TokenBuffer &buffer);
+
+  /// @brief Returns the token n positions ahead of the current one without consuming anything. n < LOOKAHEAD.
+  /// The reference points into the lookahead ring and stays valid until the token has been consumed.
+  const Token &peek(size_t n = 0);
+  /// @brief Consumes and returns the current token.
+  Token advance();
+  /// @brief Creates the SourcePos of a token for error reporting.
+  shared_ptr<SourcePos> pos(const Token &tk) const;
+
+private:
+  optional<Lexer> lex;               // set in streaming mode
+  const TokenBuffer *buffer;         // set in buffer mode
+  size_t index = 0;                  // position inside buffer of the next token to move into the ring
+  std::array<Token, LOOKAHEAD> ring; // tokens which have been scanned but not consumed
+  size_t head = 0;
+  size_t count = 0;
+
+  void fill(size_t n);
 };
 
-regex_handler default_handler(TokenKind kind, const string &value);
-void string_handler(Lexer &lex, const regex &re);
-void number_handler(Lexer &lex, const regex &re);
-void symbol_handler(Lexer &lex, const regex &re);
-void skip_handler(Lexer &lex, const regex &re);
-void comment_handler(Lexer &lex, const regex &re);
-} // namespace lexer
\ No newline at end of file
+void default_handler(Lexer &lex, TokenKind kind, size_t length);
+void string_handler(Lexer &lex);
+void number_handler(Lexer &lex);
+void symbol_handler(Lexer &lex);
+void skip_handler(Lexer &lex);
+void comment_handler(Lexer &lex);
+} // namespace lexer
@@ -0,0 +1,90 @@
+#include <algorithm>
+
+#include "lexer.h"
+
+using namespace lexer;
+
+shared_ptr<SourceFile> lexer::apply_edit(const SourceFile &file, const Edit &edit) {
+  string contents;
+  contents.reserve(file.contents.length() - edit.removed + edit.inserted.length());
+  contents += file.contents.substr(0, edit.offset);
+  contents += edit.inserted;
+  contents += file.contents.substr(edit.offset + edit.removed);
+
+  return SourceFile::from_string(file.file_path, std::move(contents));
+}
+
+pair<TokenBuffer, vector<errors::Err>> lexer::relex(TokenBuffer previous, shared_ptr<SourceFile> edited,
+                                                    const Edit &edit) {
+  Lexer lex{edited};
+  if (lex.errs.size() != 0) {
+    return make_pair(std::move(lex.tokens), lex.errs);
+  }
+
+  lex.relex(std::move(previous), edit);
+  return make_pair(std::move(lex.tokens), lex.errs);
+}
+
+// The scanner holds no state besides its position and looks at most one byte past the end of a token. A token which
+// ends two or more bytes before the edit therefore lexes the same way in both versions of the file, and so does a
+// token which starts at the same place in the unchanged tail of both.
+void lexer::Lexer::relex(TokenBuffer previous, const Edit &edit) {
+  // Every buffer from tokenize ends in END_FILE, unless the file failed to load.
+  if (previous.size() > 0) {
+    previous.pop();
+  }
+
+  size_t count = previous.size();
+  auto end_of = [&](size_t i) { return (size_t)previous.offsets[i] + previous.lengths[i]; };
+
+  // Keep every token whose lookahead stays clear of the edit.
+  size_t keep = std::lower_bound(previous.offsets.begin(), previous.offsets.end(), edit.offset) -
+                previous.offsets.begin();
+  while (keep > 0 && end_of(keep - 1) + 2 > edit.offset) {
+    keep--;
+  }
+
+  int64_t delta = (int64_t)edit.inserted.length() - (int64_t)edit.removed;
+  size_t tail = edit.offset + edit.inserted.length(); // first byte after the edit in the new file
+  size_t resume = count;                              // first previous token which is reused
+  pos = keep > 0 ? end_of(keep - 1) : 0;
+  tokens.clear();
+
+  while (!at_eof() && errs.size() == 0) {
+    size_t before = tokens.size();
+    scan_token();
+
+    if (tokens.size() == before || tokens.offsets.back() < tail) {
+      continue;
+    }
+
+    uint32_t old_offset = (uint32_t)(tokens.offsets.back() - delta);
+    auto it = std::lower_bound(previous.offsets.begin() + keep, previous.offsets.begin() + count, old_offset);
+
+    if (it != previous.offsets.begin() + count && *it == old_offset) {
+      tokens.pop();
+      resume = it - previous.offsets.begin();
+      break;
+    }
+  }
+
+  // previous becomes [kept tokens] + [re-lexed tokens] + [reused tokens, shifted].
+  size_t relexed = tokens.size();
+  previous.splice(keep, resume, tokens);
+
+  for (size_t i = keep + relexed; i < previous.size(); i++) {
+    previous.offsets[i] = (uint32_t)(previous.offsets[i] + delta);
+  }
+
+  previous.file = file;
+  tokens = std::move(previous);
+
+  // Reused tokens run up to where the old stream stopped. Scanning on from the last of them reproduces whatever came
+  // after it, the trailing whitespace and comments or the error which ended lexing.
+  if (resume < count) {
+    pos = tokens.offsets.back() + tokens.lengths.back();
+    scan_until(SIZE_MAX);
+  }
+
+  push(END_FILE, pos, pos);
+}
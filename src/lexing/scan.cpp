@@ -0,0 +1,361 @@
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BEDROCK_SCAN_X86
+#include <immintrin.h>
+#endif
+
+using namespace lexer::scan;
+
+// ---------------------
+// Scalar kernels
+// ---------------------
+
+static bool is_whitespace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_identifier(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static const char *scalar_skip_whitespace(const char *p, const char *end) {
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+
+  return p;
+}
+
+static const char *scalar_skip_identifier(const char *p, const char *end) {
+  while (p < end && is_identifier(*p)) {
+    p++;
+  }
+
+  return p;
+}
+
+static const char *scalar_find_line_end(const char *p, const char *end) {
+  while (p < end && *p != '\n' && *p != '\r') {
+    p++;
+  }
+
+  return p;
+}
+
+static const char *scalar_find_quote(const char *p, const char *end) {
+  while (p < end && *p != '"') {
+    p++;
+  }
+
+  return p;
+}
+
+static size_t scalar_count_newlines(const char *p, const char *end) {
+  size_t count = 0;
+
+  for (; p < end; p++) {
+    count += *p == '\n';
+  }
+
+  return count;
+}
+
+static size_t scalar_line_starts(const char *begin, const char *end, uint32_t *out) {
+  size_t count = 0;
+
+  for (const char *p = begin; p < end; p++) {
+    if (*p == '\n') {
+      out[count++] = (uint32_t)(p - begin + 1);
+    }
+  }
+
+  return count;
+}
+
+static const Kernels SCALAR = {
+    "scalar",
+    scalar_skip_whitespace,
+    scalar_skip_identifier,
+    scalar_find_line_end,
+    scalar_find_quote,
+    scalar_count_newlines,
+    scalar_line_starts,
+};
+
+const Kernels &lexer::scan::scalar_kernels() {
+  return SCALAR;
+}
+
+#ifdef BEDROCK_SCAN_X86
+
+// ---------------------
+// SSE2 kernels (16 bytes)
+// ---------------------
+// Each kernel builds a mask of the bytes which end the run and returns the position of its lowest set bit. Tails
+// shorter than a full vector are handed to the scalar kernel. Bytes >= 0x80 compare as negative and so never match.
+
+static inline __m128i sse2_is_whitespace(__m128i c) {
+  __m128i control =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('\r' + 1)));
+  return _mm_or_si128(control, _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')));
+}
+
+static inline __m128i sse2_is_identifier(__m128i c) {
+  __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+  __m128i alpha =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+  __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+}
+
+static const char *sse2_skip_whitespace(const char *p, const char *end) {
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    unsigned stop = ~(unsigned)_mm_movemask_epi8(sse2_is_whitespace(c)) & 0xFFFF;
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return scalar_skip_whitespace(p, end);
+}
+
+static const char *sse2_skip_identifier(const char *p, const char *end) {
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    unsigned stop = ~(unsigned)_mm_movemask_epi8(sse2_is_identifier(c)) & 0xFFFF;
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return scalar_skip_identifier(p, end);
+}
+
+static const char *sse2_find_line_end(const char *p, const char *end) {
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    __m128i found = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\r')));
+    unsigned stop = (unsigned)_mm_movemask_epi8(found);
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return scalar_find_line_end(p, end);
+}
+
+static const char *sse2_find_quote(const char *p, const char *end) {
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    unsigned stop = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('"')));
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return scalar_find_quote(p, end);
+}
+
+static size_t sse2_count_newlines(const char *p, const char *end) {
+  size_t count = 0;
+
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    count += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))));
+  }
+
+  return count + scalar_count_newlines(p, end);
+}
+
+static size_t sse2_line_starts(const char *begin, const char *end, uint32_t *out) {
+  size_t count = 0;
+  const char *p = begin;
+
+  for (; p + 16 <= end; p += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)p);
+    unsigned found = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')));
+
+    for (; found; found &= found - 1) {
+      out[count++] = (uint32_t)(p - begin + __builtin_ctz(found) + 1);
+    }
+  }
+
+  size_t tail = scalar_line_starts(p, end, out + count);
+  for (size_t i = count; i < count + tail; i++) {
+    out[i] += (uint32_t)(p - begin);
+  }
+
+  return count + tail;
+}
+
+static const Kernels SSE2 = {
+    "sse2",
+    sse2_skip_whitespace,
+    sse2_skip_identifier,
+    sse2_find_line_end,
+    sse2_find_quote,
+    sse2_count_newlines,
+    sse2_line_starts,
+};
+
+// ---------------------
+// AVX2 kernels (32 bytes)
+// ---------------------
+
+#define AVX2 __attribute__((target("avx2,popcnt")))
+
+AVX2 static inline __m256i avx2_is_whitespace(__m256i c) {
+  __m256i above_tab = _mm256_cmpgt_epi8(c, _mm256_set1_epi8('\t' - 1));
+  __m256i control = _mm256_and_si256(above_tab, _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), c));
+  return _mm256_or_si256(control, _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')));
+}
+
+AVX2 static inline __m256i avx2_is_identifier(__m256i c) {
+  __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+  __m256i above_a = _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1));
+  __m256i alpha = _mm256_and_si256(above_a, _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+  __m256i above_0 = _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1));
+  __m256i digit = _mm256_and_si256(above_0, _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+  return _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+}
+
+AVX2 static const char *avx2_skip_whitespace(const char *p, const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    unsigned stop = ~(unsigned)_mm256_movemask_epi8(avx2_is_whitespace(c));
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return sse2_skip_whitespace(p, end);
+}
+
+AVX2 static const char *avx2_skip_identifier(const char *p, const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    unsigned stop = ~(unsigned)_mm256_movemask_epi8(avx2_is_identifier(c));
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return sse2_skip_identifier(p, end);
+}
+
+AVX2 static const char *avx2_find_line_end(const char *p, const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    __m256i found =
+        _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r')));
+    unsigned stop = (unsigned)_mm256_movemask_epi8(found);
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return sse2_find_line_end(p, end);
+}
+
+AVX2 static const char *avx2_find_quote(const char *p, const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    unsigned stop = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"')));
+
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+
+  return sse2_find_quote(p, end);
+}
+
+AVX2 static size_t avx2_count_newlines(const char *p, const char *end) {
+  size_t count = 0;
+
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    count += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))));
+  }
+
+  return count + sse2_count_newlines(p, end);
+}
+
+AVX2 static size_t avx2_line_starts(const char *begin, const char *end, uint32_t *out) {
+  size_t count = 0;
+  const char *p = begin;
+
+  for (; p + 32 <= end; p += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)p);
+    unsigned found = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')));
+
+    for (; found; found &= found - 1) {
+      out[count++] = (uint32_t)(p - begin + __builtin_ctz(found) + 1);
+    }
+  }
+
+  size_t tail = sse2_line_starts(p, end, out + count);
+  for (size_t i = count; i < count + tail; i++) {
+    out[i] += (uint32_t)(p - begin);
+  }
+
+  return count + tail;
+}
+
+#undef AVX2
+
+static const Kernels AVX2_KERNELS = {
+    "avx2",
+    avx2_skip_whitespace,
+    avx2_skip_identifier,
+    avx2_find_line_end,
+    avx2_find_quote,
+    avx2_count_newlines,
+    avx2_line_starts,
+};
+
+const Kernels *lexer::scan::sse2_kernels() {
+  __builtin_cpu_init(); // required since this also runs during static initialization
+  return __builtin_cpu_supports("sse2") ? &SSE2 : nullptr;
+}
+
+const Kernels *lexer::scan::avx2_kernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") ? &AVX2_KERNELS : nullptr;
+}
+
+#else
+
+const Kernels *lexer::scan::sse2_kernels() {
+  return nullptr;
+}
+
+const Kernels *lexer::scan::avx2_kernels() {
+  return nullptr;
+}
+
+#endif
+
+static const Kernels *detect_kernels() {
+  if (auto avx2 = avx2_kernels()) {
+    return avx2;
+  }
+
+  if (auto sse2 = sse2_kernels()) {
+    return sse2;
+  }
+
+  return &scalar_kernels();
+}
+
+const Kernels *lexer::scan::ACTIVE_KERNELS = detect_kernels();
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Scanning kernels behind the lexer's hot loops. Every kernel reads the range [begin, end) and returns a
+/// pointer to the first byte which ends the run, or end when the run reaches the end of the range. x86-64 builds carry
+/// SSE2 and AVX2 versions which are picked at startup based on the running CPU. Other targets use the scalar versions.
+namespace lexer::scan {
+
+struct Kernels {
+  const char *name;
+  /// @brief Skips ' ', '\t', '\n', '\v', '\f' and '\r'.
+  const char *(*skip_whitespace)(const char *begin, const char *end);
+  /// @brief Skips [a-zA-Z0-9_].
+  const char *(*skip_identifier)(const char *begin, const char *end);
+  /// @brief Finds the first '\n' or '\r'. Used to find the end of a line comment.
+  const char *(*find_line_end)(const char *begin, const char *end);
+  /// @brief Finds the first '"'.
+  const char *(*find_quote)(const char *begin, const char *end);
+  /// @brief Returns the number of '\n' characters in the range.
+  size_t (*count_newlines)(const char *begin, const char *end);
+  /// @brief Writes the offset from begin of the byte following every '\n' into out and returns how many were written.
+  /// out must have room for count_newlines(begin, end) entries.
+  size_t (*line_starts)(const char *begin, const char *end, uint32_t *out);
+};
+
+const Kernels &scalar_kernels();
+/// @brief Returns nullptr when the running CPU does not support SSE2.
+const Kernels *sse2_kernels();
+/// @brief Returns nullptr when the running CPU does not support AVX2.
+const Kernels *avx2_kernels();
+
+/// @brief The fastest set of kernels supported by the running CPU.
+extern const Kernels *ACTIVE_KERNELS;
+
+inline const char *skip_whitespace(const char *begin, const char *end) {
+  return ACTIVE_KERNELS->skip_whitespace(begin, end);
+}
+
+inline const char *skip_identifier(const char *begin, const char *end) {
+  return ACTIVE_KERNELS->skip_identifier(begin, end);
+}
+
+inline const char *find_line_end(const char *begin, const char *end) {
+  return ACTIVE_KERNELS->find_line_end(begin, end);
+}
+
+inline const char *find_quote(const char *begin, const char *end) {
+  return ACTIVE_KERNELS->find_quote(begin, end);
+}
+
+inline size_t count_newlines(const char *begin, const char *end) {
+  return ACTIVE_KERNELS->count_newlines(begin, end);
+}
+
+inline size_t line_starts(const char *begin, const char *end, uint32_t *out) {
+  return ACTIVE_KERNELS->line_starts(begin, end, out);
+}
+}; // namespace lexer::scan
@@ -0,0 +1,104 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "../bedrock.h"
+#include "scan.h"
+
+using namespace lexer;
+
+shared_ptr<SourceFile> lexer::SourceFile::open(const string &file_path) {
+  auto file = make_shared<SourceFile>();
+  file->file_path = file_path;
+
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+      ::close(fd);
+
+      file->mapping = mapping;
+      file->mapping_size = (size_t)info.st_size;
+      file->contents = string_view((const char *)mapping, file->mapping_size);
+      return file;
+    }
+  }
+
+  ::close(fd);
+
+  // Pipes, character devices, empty files or a failed mapping
+  auto contents = utils::read_file_contents(file_path);
+  if (!contents.has_value()) {
+    return nullptr;
+  }
+
+  file->buffer = std::move(contents.value());
+  file->contents = file->buffer;
+  return file;
+}
+
+shared_ptr<SourceFile> lexer::SourceFile::from_string(const string &file_path, string contents) {
+  auto file = make_shared<SourceFile>();
+  file->file_path = file_path;
+  file->buffer = std::move(contents);
+  file->contents = file->buffer;
+  return file;
+}
+
+lexer::SourceFile::~SourceFile() {
+  if (mapping) {
+    munmap(mapping, mapping_size);
+  }
+}
+
+const vector<uint32_t> &lexer::SourceFile::lines() {
+  std::call_once(line_index_built, [this]() {
+    const char *begin = contents.data();
+    const char *end = begin + contents.length();
+
+    line_index.resize(scan::count_newlines(begin, end) + 1);
+    line_index[0] = 0;
+    scan::line_starts(begin, end, line_index.data() + 1);
+  });
+
+  return line_index;
+}
+
+size_t lexer::SourceFile::line_of(size_t offset) {
+  const auto &starts = lines();
+  return std::upper_bound(starts.begin(), starts.end(), (uint32_t)offset) - starts.begin();
+}
+
+size_t lexer::SourceFile::column_of(size_t offset) {
+  return offset - lines()[line_of(offset) - 1] + 1;
+}
+
+string_view lexer::SourceFile::line_text(size_t line) {
+  const auto &starts = lines();
+  if (line == 0 || line > starts.size()) {
+    return string_view();
+  }
+
+  size_t start = starts[line - 1];
+  size_t end = line < starts.size() ? starts[line] - 1 : contents.length();
+
+  if (end > start && contents[end - 1] == '\r') {
+    end--;
+  }
+
+  return contents.substr(start, end - start);
+}
+
+size_t lexer::SourceFile::line_count() {
+  return lines().size();
+}
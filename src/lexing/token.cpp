@@ -1,11 +1,19 @@
 #include "token.h"
 
+#include <algorithm>
+
 using namespace lexer;
 
+void lexer::Token::display_json(std::ostream &out) const {
+  out << "{\"kind\":\"" << token_tag(kind) << "\",\"offset\":" << offset << ",\"length\":" << length << ",\"value\":";
+  utils::write_json_string(out, value);
+  out << "}\n";
+}
+
 string lexer::SourcePos::error_str() {
   string s = "(" + ul(this->file->file_path) + ")[";
 
-  s += to_string(this->line) + ":";
+  s += to_string(this->line()) + ":";
   s += to_string(this->start) + ":";
   s += to_string(this->end) + "]";
 
@@ -13,13 +21,38 @@ string lexer::SourcePos::error_str() {
 }
 
 string lexer::SourcePos::get_snippet(bool showUnderline, size_t linePaddings) {
-  UNUSED(showUnderline);
-  UNUSED(linePaddings);
+  size_t line = this->line();
+  size_t first = line > linePaddings ? line - linePaddings : 1;
+  size_t last = std::min(line + linePaddings, file->line_count());
+  size_t gutter = to_string(last).length();
+  string snippet;
+
+  for (size_t n = first; n <= last; n++) {
+    string number = to_string(n);
+    string_view text = file->line_text(n);
+
+    snippet += utils::space(gutter - number.length()) + blue(number) + " | " + string(text) + "\n";
+
+    if (!showUnderline || n != line) {
+      continue;
+    }
+
+    // Underline the part of the range which falls on the first line. Tabs are kept so the carets line up.
+    size_t column = this->column() - 1;
+    size_t width = std::max<size_t>(1, std::min(end, start + text.length() - column) - start);
+    string padding;
 
-  TODO("lexer::SourcePos::get_snippet() not yet implimented");
+    for (size_t i = 0; i < column && i < text.length(); i++) {
+      padding += text[i] == '\t' ? '\t' : ' ';
+    }
+
+    snippet += utils::space(gutter) + " | " + padding + bold_red(string(width, '^')) + "\n";
+  }
+
+  return snippet;
 }
 
-string lexer::token_tag(TokenKind kind) {
+const char *lexer::token_tag(TokenKind kind) {
   switch (kind) {
   case END_FILE:
     return "eof";
@@ -176,6 +209,83 @@ string lexer::token_tag(TokenKind kind) {
   case FMT_MACRO:
     return "@fmt";
   default:
-    return "unknown_tk " + to_string(kind);
+    return "unknown_tk";
+  }
+}
+
+const char *lexer::token_text(TokenKind kind) {
+  switch (kind) {
+  case OPEN_PAREN:
+    return "(";
+  case CLOSE_PAREN:
+    return ")";
+  case OPEN_CURLY:
+    return "{";
+  case CLOSE_CURLY:
+    return "}";
+  case OPEN_BRACKET:
+    return "[";
+  case CLOSE_BRACKET:
+    return "]";
+  case COLON:
+    return ":";
+  case SEMICOLON:
+    return ";";
+  case COMMA:
+    return ",";
+  case ASSIGNMENT:
+    return "=";
+  case NOT:
+    return "!";
+  case NOT_EQUALS:
+    return "!=";
+  case EQUALS:
+    return "==";
+  case LESS:
+  case OPEN_GENERIC:
+    return "<";
+  case LESS_EQ:
+    return "<=";
+  case GREATER:
+  case CLOSE_GENERIC:
+    return ">";
+  case GREATER_EQ:
+    return ">=";
+  case PLUS:
+    return "+";
+  case MINUS:
+    return "-";
+  case STAR:
+    return "*";
+  case SLASH:
+    return "/";
+  case PERCENT:
+    return "%";
+  case DOT:
+    return ".";
+  case DOT_DOT:
+    return "..";
+  case ARROW:
+    return "->";
+  case COLON_COLON:
+    return "::";
+  case QUESTION:
+    return "?";
+  case PLUS_PLUS:
+    return "++";
+  case MINUS_MINUS:
+    return "--";
+  case PLUS_EQUALS:
+    return "+=";
+  case MINUS_EQUALS:
+    return "-=";
+  case SLASH_EQUALS:
+    return "/=";
+  case STAR_EQUALS:
+    return "*=";
+  case AMPERSAND:
+    return "&";
+  default:
+    return token_tag(kind);
   }
-}
\ No newline at end of file
+}
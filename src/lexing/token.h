@@ -1,6 +1,6 @@
 #pragma once
 
-#include <unordered_map>
+#include <iterator>
 
 #include "../bedrock.h"
 #include "../util/utils.h"
@@ -91,7 +91,15 @@ enum TokenKind {
   LOG_MACRO,
 };
 
-const unordered_map<string, TokenKind> reserved_lu = {
+/// @brief Number of TokenKinds, for tables indexed by kind. LOG_MACRO must stay the last kind.
+constexpr size_t TOKEN_KIND_COUNT = LOG_MACRO + 1;
+
+struct ReservedWord {
+  string_view text;
+  TokenKind kind;
+};
+
+constexpr ReservedWord reserved_words[] = {
     {"let", LET},
     {"const", CONST},
     {"pub", PUB},
@@ -112,7 +120,6 @@ const unordered_map<string, TokenKind> reserved_lu = {
     {"static", STATIC},
     {"while", WHILE},
     {"for", FOR},
-    {"as", AS},
     {"trait", TRAIT},
     {"typeof", TYPEOF},
     {"in", IN},
@@ -137,37 +144,186 @@ const unordered_map<string, TokenKind> reserved_lu = {
     {"@fmt", FMT_MACRO},
 };
 
-string token_tag(TokenKind kind);
+/// @brief Perfect hash over reserved_words. The hash only reads the length and the first, second and last characters
+/// so classifying an identifier costs a few loads, one multiply and at most one string compare. The seed and the table
+/// are both found at compile time; adding a keyword which cannot be placed fails the build.
+namespace reserved {
+constexpr size_t TABLE_SIZE = 128;
+constexpr size_t MAX_LENGTH = 9;
 
-struct Token {
-  shared_ptr<lexer::SourcePos> pos;
-  TokenKind kind;
-  string value;
+constexpr uint32_t hash(string_view word, uint32_t seed) {
+  uint32_t h = (uint8_t)word[0] | (uint8_t)word[1] << 8 | (uint8_t)word[word.length() - 1] << 16;
+  h = (h ^ (uint32_t)word.length() << 24) * seed;
+  return h >> 25; // top 7 bits, one slot of TABLE_SIZE
+}
+
+/// @brief Returns the first seed which places every reserved word into its own slot, or 0 when none is found.
+constexpr uint32_t find_seed() {
+  for (uint32_t seed = 0x9E3779B1; seed < 0x9E3779B1 + 20000; seed += 2) {
+    bool used[TABLE_SIZE] = {};
+    bool collides = false;
+
+    for (const auto &word : reserved_words) {
+      uint32_t slot = hash(word.text, seed);
+      collides = collides || used[slot];
+      used[slot] = true;
+    }
+
+    if (!collides) {
+      return seed;
+    }
+  }
+
+  return 0;
+}
 
-  // Default constructor
-  Token() {
+constexpr uint32_t SEED = find_seed();
+static_assert(SEED != 0, "no perfect hash seed found for reserved_words. Widen the search or grow TABLE_SIZE.");
+
+struct Table {
+  // Index + 1 into reserved_words. 0 marks an empty slot.
+  uint8_t slots[TABLE_SIZE] = {};
+
+  constexpr Table() {
+    for (size_t i = 0; i < std::size(reserved_words); i++) {
+      slots[hash(reserved_words[i].text, SEED)] = (uint8_t)(i + 1);
+    }
   }
+};
 
-  Token(lexer::SourcePos pos, TokenKind kind, string value)
-      : pos(make_shared<SourcePos>(pos)), kind(kind), value(value) {
+constexpr Table TABLE{};
+}; // namespace reserved
+
+/// @brief Classifies an identifier. Returns the keyword's TokenKind or IDENTIFIER when word is not reserved.
+constexpr TokenKind reserved_kind(string_view word) {
+  if (word.length() < 2 || word.length() > reserved::MAX_LENGTH) {
+    return IDENTIFIER;
   }
 
-  Token(TokenKind kind, string value) : kind(kind), value(value) {
-    pos->file = nullptr;
-    pos->line = 0;
-    pos->start = 0;
-    pos->end = 0;
+  uint8_t slot = reserved::TABLE.slots[reserved::hash(word, reserved::SEED)];
+  if (slot != 0 && reserved_words[slot - 1].text == word) {
+    return reserved_words[slot - 1].kind;
   }
 
+  return IDENTIFIER;
+}
+
+static_assert(reserved_kind("interface") == INTERFACE && reserved_kind("@fmt") == FMT_MACRO);
+static_assert(reserved_kind("lets") == IDENTIFIER && reserved_kind("x") == IDENTIFIER);
+
+/// @brief Returns the name of a TokenKind. Used for debug output and error messages.
+const char *token_tag(TokenKind kind);
+/// @brief Returns how a punctuation or operator token is spelled in source, or its tag for every other kind.
+const char *token_text(TokenKind kind);
+
+/// @brief Lightweight handle to a single token inside a TokenBuffer. It owns nothing, value is a view into the
+/// contents of the SourceFile the token was lexed from.
+struct Token {
+  TokenKind kind;
+  uint32_t offset; // byte offset of the first character of the lexeme
+  uint32_t length; // length of the lexeme in bytes. Includes the quotes of string literals.
+  utils::SymbolId symbol; // interned name of IDENTIFIER tokens, 0 for every other kind
+  string_view value;
+
   void display() const {
     std::cout << bold_white(token_tag(this->kind)) << " (";
 
     if (this->kind == IDENTIFIER || this->kind == NUMBER || this->kind == STRING) {
-      std::cout << blue(this->value);
+      std::cout << blue(string(this->value));
     }
 
     std::cout << ")\n";
   }
+
+  /// @brief Writes the token as a single line JSON object holding its tag, position and lexeme.
+  void display_json(std::ostream &out) const;
+};
+
+/// @brief Struct-of-arrays storage for the output of the lexer. Every token costs 13 bytes and none of them allocate.
+/// Tokens are only valid while the SourceFile they point into is alive. Lines are not stored, see SourceFile::line_of.
+struct TokenBuffer {
+  shared_ptr<SourceFile> file;
+  vector<uint8_t> kinds;
+  vector<uint32_t> offsets;
+  vector<uint32_t> lengths;
+  vector<utils::SymbolId> symbols;
+
+  size_t size() const {
+    return kinds.size();
+  }
+
+  void push(TokenKind kind, size_t offset, size_t length, utils::SymbolId symbol = 0) {
+    kinds.push_back((uint8_t)kind);
+    offsets.push_back((uint32_t)offset);
+    lengths.push_back((uint32_t)length);
+    symbols.push_back(symbol);
+  }
+
+  /// @brief Appends the tokens of other starting at index `from`. Both buffers must point into the same file.
+  void append(const TokenBuffer &other, size_t from = 0) {
+    kinds.insert(kinds.end(), other.kinds.begin() + from, other.kinds.end());
+    offsets.insert(offsets.end(), other.offsets.begin() + from, other.offsets.end());
+    lengths.insert(lengths.end(), other.lengths.begin() + from, other.lengths.end());
+    symbols.insert(symbols.end(), other.symbols.begin() + from, other.symbols.end());
+  }
+
+  /// @brief Replaces the tokens in [from, to) with every token of other.
+  void splice(size_t from, size_t to, const TokenBuffer &other) {
+    replace(kinds, from, to, other.kinds);
+    replace(offsets, from, to, other.offsets);
+    replace(lengths, from, to, other.lengths);
+    replace(symbols, from, to, other.symbols);
+  }
+
+  void pop() {
+    kinds.pop_back();
+    offsets.pop_back();
+    lengths.pop_back();
+    symbols.pop_back();
+  }
+
+  /// @brief Removes every token but keeps the allocated capacity.
+  void clear() {
+    kinds.clear();
+    offsets.clear();
+    lengths.clear();
+    symbols.clear();
+  }
+
+  TokenKind kind(size_t i) const {
+    return (TokenKind)kinds[i];
+  }
+
+  /// @brief Returns the raw lexeme of the token at index i.
+  string_view text(size_t i) const {
+    return string_view(file->contents).substr(offsets[i], lengths[i]);
+  }
+
+  /// @brief Returns the value of the token at index i. Same as text() except string literals have their quotes removed.
+  string_view value(size_t i) const {
+    auto text = this->text(i);
+
+    if (kind(i) == STRING) {
+      return text.substr(1, text.length() - 2);
+    }
+
+    return text;
+  }
+
+  Token at(size_t i) const {
+    return Token{kind(i), offsets[i], lengths[i], symbols[i], value(i)};
+  }
+
+  /// @brief Creates the SourcePos of a token for error reporting.
+  shared_ptr<SourcePos> pos(const Token &tk) const {
+    return make_shared<SourcePos>(SourcePos{file, tk.offset, (size_t)tk.offset + tk.length});
+  }
+
+private:
+  template <typename T> static void replace(vector<T> &column, size_t from, size_t to, const vector<T> &with) {
+    column.erase(column.begin() + from, column.begin() + to);
+    column.insert(column.begin() + from, with.begin(), with.end());
+  }
 };
 
-} // namespace lexer
\ No newline at end of file
+} // namespace lexer
@@ -5,46 +5,42 @@ using namespace parser;
 using namespace ast;
 using namespace lexer;
 
-Err parser::bad_lu_handler_err(string hname, Token tk) {
+Err parser::bad_lu_handler_err(string hname, Parser &p, Token tk) {
   auto err = Err(ErrKind::UnexpectedToken);
   err.message("Cannot parse expression at current token " + bold_red(token_tag(tk.kind)));
   err.hint("This token is not supported in the current context.");
   err.hint("Could be a parser::" + hname + "::error");
-  err.location(tk.pos);
+  err.location(p.location(tk));
 
   return err;
 }
 
 led_handler parser::get_led(Parser &p) {
-  auto tk = p.current_tk();
-  auto it = led_lu.find(tk.kind);
-
-  if (it != led_lu.end()) {
-    return led_lu.at(tk.kind);
+  const auto &tk = p.current_tk();
+  if (led_handler handler = led_lu[tk.kind]) {
+    return handler;
   }
 
-  auto err = bad_lu_handler_err("led()", tk);
+  auto err = bad_lu_handler_err("led()", p, tk);
   p.expect(); // advance past char since it has no null
   p.report(err);
   return nullptr;
 }
 
 nud_handler parser::get_nud(Parser &p) {
-  auto tk = p.current_tk();
-  auto it = nud_lu.find(tk.kind);
-
-  if (it != nud_lu.end()) {
-    return nud_lu.at(tk.kind);
+  const auto &tk = p.current_tk();
+  if (nud_handler handler = nud_lu[tk.kind]) {
+    return handler;
   }
 
-  auto err = bad_lu_handler_err("nud()", tk);
+  auto err = bad_lu_handler_err("nud()", p, tk);
   p.expect(); // advance past char since it has no null
   p.report(err);
   return nullptr;
 }
 
-shared_ptr<ast::Expr> parser::parse_expr(Parser &p, BindingPower bp) {
-  shared_ptr<Expr> left;
+ast::Expr *parser::parse_expr(Parser &p, BindingPower bp) {
+  Expr *left;
   nud_handler nud = get_nud(p);
 
   left = nud(p);
@@ -57,24 +53,24 @@ shared_ptr<ast::Expr> parser::parse_expr(Parser &p, BindingPower bp) {
   return left;
 }
 
-shared_ptr<ast::Expr> parser::parse_primary_expr(Parser &p) {
-  auto tk = p.current_tk();
+ast::Expr *parser::parse_primary_expr(Parser &p) {
+  const auto &tk = p.current_tk();
   switch (tk.kind) {
   case IDENTIFIER: {
-    auto expr = make_shared<SymbolExpr>();
-    expr->symbol = p.expect().value;
+    auto expr = p.make<SymbolExpr>();
+    expr->symbol = p.expect().symbol;
     return expr;
   }
 
   case NUMBER: {
-    auto expr = make_shared<NumberExpr>();
-    expr->value = p.expect(NUMBER).value;
+    auto expr = p.make<NumberExpr>();
+    expr->value = string(p.expect(NUMBER).value);
     return expr;
   }
 
   case STRING: {
-    auto expr = make_shared<StringExpr>();
-    expr->value = p.expect().value;
+    auto expr = p.make<StringExpr>();
+    expr->value = string(p.expect().value);
     return expr;
   }
 
@@ -83,48 +79,47 @@ shared_ptr<ast::Expr> parser::parse_primary_expr(Parser &p) {
     err.message("Could not parse primary-expression.");
     err.hint("The expected token should be that of [NUMBER|STRING|IDENT]");
     err.hint("This is likely an issue with the compiler.");
-    err.location(tk.pos);
+    err.location(p.location(tk));
 
     p.report(err);
     return nullptr;
   }
 }
 
-shared_ptr<ast::BinaryExpr> parser::parse_binary_expr(Parser &p, shared_ptr<Expr> left, BindingPower bp) {
-  auto binary_expr = make_shared<BinaryExpr>();
+ast::BinaryExpr *parser::parse_binary_expr(Parser &p, Expr *left, BindingPower bp) {
+  auto binary_expr = p.make<BinaryExpr>();
   binary_expr->operation = p.expect();
   binary_expr->left = left;
   binary_expr->right = parse_expr(p, bp);
   return binary_expr;
 }
 
-shared_ptr<ast::PrefixExpr> parser::parse_prefix_expr(Parser &p) {
-  auto expr = make_shared<PrefixExpr>();
+ast::PrefixExpr *parser::parse_prefix_expr(Parser &p) {
+  auto expr = p.make<PrefixExpr>();
   expr->operation = p.expect();
   expr->right = parse_expr(p, BindingPower::UNARY_BP);
 
   return expr;
 }
 
-shared_ptr<ast::Expr> parser::parse_grouping_expr(Parser &p) {
+ast::Expr *parser::parse_grouping_expr(Parser &p) {
   p.expect(lexer::OPEN_PAREN);
   auto expr = parse_expr(p, DEFAULT_BP);
   p.expect(lexer::CLOSE_PAREN);
   return expr;
 }
 
-shared_ptr<ast::AssignmentExpr> parser::parse_assignment_expr(Parser &p, shared_ptr<ast::Expr> assigne,
-                                                              BindingPower bp) {
+ast::AssignmentExpr *parser::parse_assignment_expr(Parser &p, ast::Expr *assigne, BindingPower bp) {
   p.expect(ASSIGNMENT);
-  auto expr = make_shared<AssignmentExpr>();
+  auto expr = p.make<AssignmentExpr>();
 
   expr->assigne = assigne;
   expr->value = parse_expr(p, bp);
   return expr;
 }
 
-shared_ptr<ast::CallExpr> parser::parse_call_expr(Parser &p, shared_ptr<ast::Expr> calle, BindingPower bp) {
-  auto expr = make_shared<CallExpr>();
+ast::CallExpr *parser::parse_call_expr(Parser &p, ast::Expr *calle, BindingPower bp) {
+  auto expr = p.make<CallExpr>();
   expr->calle = calle;
   p.expect(lexer::OPEN_PAREN);
 
@@ -1,5 +1,5 @@
 #pragma once
-#include <functional>
+#include <array>
 
 #include "../ast/ast.h"
 #include "../ast/ast_expr.h"
@@ -10,7 +10,6 @@
 #include "binding_power.h"
 
 namespace parser {
-extern bool PRATT_PARSER_SETUP;
 struct Parser;
 
 // Lookup Information ----------
@@ -18,39 +17,33 @@ struct Parser;
 using ast::Expr;
 using ast::Stmt;
 using ast::Type;
-using std::function;
 
 // Stmts & Expressions
-typedef function<shared_ptr<Stmt>(Parser &)> stmt_handler;
-typedef function<shared_ptr<Expr>(Parser &)> nud_handler;
-typedef function<shared_ptr<Expr>(Parser &, shared_ptr<Expr>, BindingPower)> led_handler;
+typedef Stmt * (*stmt_handler)(Parser &);
+typedef Expr * (*nud_handler)(Parser &);
+typedef Expr * (*led_handler)(Parser &, Expr *, BindingPower);
 
 // Types
-typedef function<shared_ptr<Type>(Parser &)> type_nud_handler;
-typedef function<shared_ptr<Type>(Parser &, shared_ptr<Type>, BindingPower)> type_led_handler;
+typedef Type * (*type_nud_handler)(Parser &);
+typedef Type * (*type_led_handler)(Parser &, Type *, BindingPower);
 
-extern unordered_map<lexer::TokenKind, BindingPower> bp_lu;
-extern unordered_map<lexer::TokenKind, BindingPower> type_bp_lu;
+/// @brief A table indexed by TokenKind. Kinds without a handler hold nullptr and DEFAULT_BP.
+template <typename T> using Lookup = std::array<T, lexer::TOKEN_KIND_COUNT>;
 
-extern unordered_map<lexer::TokenKind, stmt_handler> stmt_lu;
-extern unordered_map<lexer::TokenKind, nud_handler> nud_lu;
-extern unordered_map<lexer::TokenKind, led_handler> led_lu;
-extern unordered_map<lexer::TokenKind, type_nud_handler> type_nud_lu;
-extern unordered_map<lexer::TokenKind, type_led_handler> type_led_lu;
+// Built at compile time in lookups.cpp.
+extern const Lookup<BindingPower> bp_lu;
+extern const Lookup<BindingPower> type_bp_lu;
 
-void setup_pratt_parser();
-void setup_type_pratt_parser();
+extern const Lookup<stmt_handler> stmt_lu;
+extern const Lookup<nud_handler> nud_lu;
+extern const Lookup<led_handler> led_lu;
+extern const Lookup<type_nud_handler> type_nud_lu;
+extern const Lookup<type_led_handler> type_led_lu;
 
-void def_type_nud(lexer::TokenKind, type_nud_handler);
-void def_type_led(lexer::TokenKind, type_led_handler, BindingPower);
-void def_stmt(lexer::TokenKind, stmt_handler);
-void def_led(lexer::TokenKind, led_handler, BindingPower);
-void def_nud(lexer::TokenKind, nud_handler);
-
-Err bad_lu_handler_err(string, lexer::Token);
+Err bad_lu_handler_err(string, Parser &, lexer::Token);
 
 type_nud_handler get_type_nud(Parser &p);
 type_led_handler get_type_led(Parser &p);
 led_handler get_led(Parser &p);
 nud_handler get_nud(Parser &p);
-}; // namespace parser
\ No newline at end of file
+}; // namespace parser
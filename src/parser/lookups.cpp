@@ -5,83 +5,101 @@ using namespace parser;
 using namespace ast;
 using namespace lexer;
 
-std::unordered_map<lexer::TokenKind, type_nud_handler> parser::type_nud_lu{};
-std::unordered_map<lexer::TokenKind, type_led_handler> parser::type_led_lu{};
-std::unordered_map<lexer::TokenKind, BindingPower> parser::bp_lu{};
-std::unordered_map<lexer::TokenKind, nud_handler> parser::nud_lu{};
-std::unordered_map<lexer::TokenKind, BindingPower> parser::type_bp_lu{};
-std::unordered_map<lexer::TokenKind, led_handler> parser::led_lu{};
-std::unordered_map<lexer::TokenKind, stmt_handler> parser::stmt_lu{};
-
-void parser::def_type_nud(TokenKind k, type_nud_handler h) {
-  type_nud_lu[k] = h; //
-}
+namespace {
+// The handlers return their own node types, so each def_* wraps the handler in a captureless lambda which upcasts
+// the result. The lambdas decay to plain function pointers, which keeps every table a constant expression.
+struct Tables {
+  Lookup<BindingPower> bp{};
+  Lookup<BindingPower> type_bp{};
+  Lookup<stmt_handler> stmt{};
+  Lookup<nud_handler> nud{};
+  Lookup<led_handler> led{};
+  Lookup<type_nud_handler> type_nud{};
+  Lookup<type_led_handler> type_led{};
 
-void parser::def_type_led(TokenKind k, type_led_handler h, BindingPower bp) {
-  type_bp_lu[k] = bp;
-  type_led_lu[k] = h;
-}
+  template <auto handler> constexpr void def_type_nud(TokenKind kind) {
+    type_nud[kind] = [](Parser &p) -> Type * { return handler(p); };
+  }
 
-void parser::def_stmt(TokenKind kind, stmt_handler handler) {
-  stmt_lu[kind] = handler; //
-}
+  template <auto handler> constexpr void def_type_led(TokenKind kind, BindingPower power) {
+    type_bp[kind] = power;
+    type_led[kind] = [](Parser &p, Type *left, BindingPower bp) -> Type * {
+      return handler(p, left, bp);
+    };
+  }
 
-void parser::def_led(TokenKind kind, led_handler handler, BindingPower bp) {
-  led_lu[kind] = handler;
-  bp_lu[kind] = bp;
-}
+  template <auto handler> constexpr void def_stmt(TokenKind kind) {
+    stmt[kind] = [](Parser &p) -> Stmt * { return handler(p); };
+  }
 
-void parser::def_nud(TokenKind kind, nud_handler handler) {
-  nud_lu[kind] = handler; //
-}
+  template <auto handler> constexpr void def_led(TokenKind kind, BindingPower power) {
+    bp[kind] = power;
+    led[kind] = [](Parser &p, Expr *left, BindingPower bp) -> Expr * {
+      return handler(p, left, bp);
+    };
+  }
 
-inline bool parser::PRATT_PARSER_SETUP = false;
-void parser::setup_pratt_parser() {
-  if (PRATT_PARSER_SETUP)
-    return;
-  PRATT_PARSER_SETUP = true;
-  setup_type_pratt_parser();
+  template <auto handler> constexpr void def_nud(TokenKind kind) {
+    nud[kind] = [](Parser &p) -> Expr * { return handler(p); };
+  }
+};
+
+constexpr Tables build_tables() {
+  Tables t;
 
   // Stmts
-  def_stmt(lexer::STRUCT, parse_struct_stmt);
-  def_stmt(lexer::LET, parse_var_decl_stmt);
-  def_stmt(lexer::CONST, parse_var_decl_stmt);
-  def_stmt(lexer::FN, parse_fn_decl_stmt);
-  def_stmt(lexer::OPEN_CURLY, parse_block_stmt);
-  def_stmt(lexer::DEFER, parse_defer_stmt);
-  def_stmt(lexer::IMPL, parse_impl_stmt);
-  def_stmt(lexer::RETURN, parse_return_stmt);
+  t.def_stmt<parse_struct_stmt>(lexer::STRUCT);
+  t.def_stmt<parse_var_decl_stmt>(lexer::LET);
+  t.def_stmt<parse_var_decl_stmt>(lexer::CONST);
+  t.def_stmt<parse_fn_decl_stmt>(lexer::FN);
+  t.def_stmt<parse_block_stmt>(lexer::OPEN_CURLY);
+  t.def_stmt<parse_defer_stmt>(lexer::DEFER);
+  t.def_stmt<parse_impl_stmt>(lexer::IMPL);
+  t.def_stmt<parse_return_stmt>(lexer::RETURN);
+  t.def_stmt<parse_import_stmt>(lexer::IMPORT);
 
   // NUD HANDLERS
-  def_nud(lexer::OPEN_PAREN, parse_grouping_expr);
-  def_nud(lexer::MINUS, parse_prefix_expr);
-  def_nud(lexer::NOT, parse_prefix_expr);
-  def_nud(lexer::STAR, parse_prefix_expr);
-  def_nud(lexer::AMPERSAND, parse_prefix_expr);
-  def_nud(lexer::NUMBER, parse_primary_expr);
-  def_nud(lexer::STRING, parse_primary_expr);
-  def_nud(lexer::IDENTIFIER, parse_primary_expr);
+  t.def_nud<parse_grouping_expr>(lexer::OPEN_PAREN);
+  t.def_nud<parse_prefix_expr>(lexer::MINUS);
+  t.def_nud<parse_prefix_expr>(lexer::NOT);
+  t.def_nud<parse_prefix_expr>(lexer::STAR);
+  t.def_nud<parse_prefix_expr>(lexer::AMPERSAND);
+  t.def_nud<parse_primary_expr>(lexer::NUMBER);
+  t.def_nud<parse_primary_expr>(lexer::STRING);
+  t.def_nud<parse_primary_expr>(lexer::IDENTIFIER);
 
   // MACROS
-  def_nud(lexer::FMT_MACRO, parse_fmt_macro);
-  def_nud(lexer::STRING_MACRO, parse_str_macro);
-  def_nud(lexer::NUMBER_MACRO, parse_num_macro);
-  def_nud(lexer::LOG_MACRO, parse_log_macro);
+  t.def_nud<parse_fmt_macro>(lexer::FMT_MACRO);
+  t.def_nud<parse_str_macro>(lexer::STRING_MACRO);
+  t.def_nud<parse_num_macro>(lexer::NUMBER_MACRO);
+  t.def_nud<parse_log_macro>(lexer::LOG_MACRO);
 
   // LED HANLDERS
-  def_led(lexer::ASSIGNMENT, parse_assignment_expr, ASSIGNMENT_BP);
-  def_led(lexer::OPEN_PAREN, parse_call_expr, CALL_BP);
+  t.def_led<parse_assignment_expr>(lexer::ASSIGNMENT, ASSIGNMENT_BP);
+  t.def_led<parse_call_expr>(lexer::OPEN_PAREN, CALL_BP);
+
+  t.def_led<parse_binary_expr>(lexer::PLUS, ADDITIVE_BP);
+  t.def_led<parse_binary_expr>(lexer::MINUS, ADDITIVE_BP);
 
-  def_led(lexer::PLUS, parse_binary_expr, ADDITIVE_BP);
-  def_led(lexer::MINUS, parse_binary_expr, ADDITIVE_BP);
+  t.def_led<parse_binary_expr>(lexer::STAR, MULTIPLICATIVE_BP);
+  t.def_led<parse_binary_expr>(lexer::SLASH, MULTIPLICATIVE_BP);
+  t.def_led<parse_binary_expr>(lexer::PERCENT, MULTIPLICATIVE_BP);
 
-  def_led(lexer::STAR, parse_binary_expr, MULTIPLICATIVE_BP);
-  def_led(lexer::SLASH, parse_binary_expr, MULTIPLICATIVE_BP);
-  def_led(lexer::PERCENT, parse_binary_expr, MULTIPLICATIVE_BP);
+  // Types
+  t.def_type_nud<parse_symbol_type>(lexer::IDENTIFIER);
+  t.def_type_nud<parse_pointer_type>(lexer::AMPERSAND);
+  t.def_type_nud<parse_fn_type>(lexer::FN);
+
+  return t;
 }
 
-void parser::setup_type_pratt_parser() {
-  def_type_nud(lexer::IDENTIFIER, parse_symbol_type);
-  def_type_nud(lexer::AMPERSAND, parse_pointer_type);
-  def_type_nud(lexer::FN, parse_fn_type);
-}
\ No newline at end of file
+constexpr Tables TABLES = build_tables();
+}; // namespace
+
+constinit const Lookup<BindingPower> parser::bp_lu = TABLES.bp;
+constinit const Lookup<BindingPower> parser::type_bp_lu = TABLES.type_bp;
+constinit const Lookup<stmt_handler> parser::stmt_lu = TABLES.stmt;
+constinit const Lookup<nud_handler> parser::nud_lu = TABLES.nud;
+constinit const Lookup<led_handler> parser::led_lu = TABLES.led;
+constinit const Lookup<type_nud_handler> parser::type_nud_lu = TABLES.type_nud;
+constinit const Lookup<type_led_handler> parser::type_led_lu = TABLES.type_led;
@@ -1,13 +1,20 @@
 #include "parser.h"
 
+#include <filesystem>
+
+#include "../ast/cache.h"
+#include "../ast/dump.h"
 #include "lookup.h"
 
 using namespace parser;
 
-shared_ptr<ParserManager> Parser::manager = nullptr;
+shared_ptr<ast::ProgramStmt> parser::parse(string file_path, bool check_only) {
+  // Tokens are streamed into the parser unless they are being displayed, which needs the full stream up front.
+  if (!DISPLAY_TOKENS) {
+    lexer::TokenStream tokens{file_path};
+    return parser::parse(tokens, check_only);
+  }
 
-shared_ptr<ast::ProgramStmt> parser::parse(string file_path) {
-  // TODO: Generalize DISPLAY_TOKENS, DISPLAY_AST CHECK
   auto [tokens, errors] = lexer::tokenize(file_path);
 
   if (errors.size() > 0) {
@@ -18,42 +25,87 @@ shared_ptr<ast::ProgramStmt> parser::parse(string file_path) {
     return nullptr;
   }
 
-  if (DISPLAY_TOKENS) {
+  if (DUMP_JSON) {
+    for (size_t i = 0; i < tokens.size(); i++) {
+      tokens.at(i).display_json(std::cout);
+    }
+  } else {
     std::cout << "\nTokens: " << to_string(tokens.size()) << "\n";
-    for (const auto &token : tokens) {
-      token.display();
+    for (size_t i = 0; i < tokens.size(); i++) {
+      tokens.at(i).display();
     }
     std::cout << std::endl;
   }
 
-  return parser::parse(tokens);
+  return parser::parse(tokens, check_only);
 }
 
-shared_ptr<ast::ProgramStmt> parser::parse(vector<lexer::Token> &tokens) {
+shared_ptr<ast::ProgramStmt> parser::parse(lexer::TokenBuffer &tokens, bool check_only) {
+  lexer::TokenStream stream{tokens};
+  return parser::parse(stream, check_only);
+}
+
+shared_ptr<ast::ProgramStmt> parser::parse(lexer::TokenStream &tokens, bool check_only) {
   Parser parser{tokens};
-  parser.pos = 0;
-  parser.file = tokens.at(0).pos->file;
+  parser.manager = make_shared<ParserManager>();
 
-  setup_pratt_parser();
+  // The entry is parsed on this thread while the modules it imports are parsed on the pool.
+  ModuleScheduler imports{utils::thread_pool(), parser.manager};
+  imports.check_only = check_only && AST_CACHE;
+  imports.claim(std::filesystem::path(tokens.file->file_path).lexically_normal().string());
+  parser.imports = &imports;
 
-  if (parser.manager == nullptr) {
-    parser.manager = make_shared<ParserManager>();
+  auto program = make_shared<ast::ProgramStmt>();
+  shared_ptr<ast::ModuleStmt> entry_module;
+  try {
+    entry_module = load_module(parser);
+    entry_module->is_entry = true;
+  } catch (ParseAborted) {
+    std::lock_guard lock(parser.manager->mutex);
+    if (parser.error) {
+      parser.manager->errors.push_back(*parser.error);
+    }
   }
 
-  auto program = make_shared<ast::ProgramStmt>();
-  auto entry_module = parse_module(parser);
-  entry_module->is_entry = true;
+  // Imports already queued are still using the pool and the interner, so nothing exits before they are done.
+  imports.wait();
+
+  // Lexing stops at the first error and ends the stream early.
+  auto &lexing_errors = tokens.errs.size() > 0 ? tokens.errs : imports.lexing_errors;
+  if (lexing_errors.size() > 0) {
+    for (auto &err : lexing_errors) {
+      err.display();
+    }
 
-  if (Parser::manager->errors.size() > 0) {
-    exit(1);
+    return nullptr;
+  }
+
+  if (parser.manager->errors.size() > 0) {
+    for (auto &err : parser.manager->errors) {
+      err.display();
+    }
+
+    return nullptr;
   }
 
   program->entry = entry_module;
-  program->modules.push_back(entry_module);
+  program->modules = imports.ordered(entry_module);
+  for (const auto &[path, iface] : imports.summaries) {
+    if (iface) {
+      program->summaries[path] = iface;
+    }
+  }
 
-  if (DISPLAY_AST) {
+  if (DISPLAY_AST && DUMP_JSON) {
+    // One line per module, so tools can consume the dump while it is written.
+    ast::JsonDumper out{std::cout};
+    for (const auto &mod : program->modules) {
+      mod->dump(out);
+    }
+  } else if (DISPLAY_AST) {
     std::cout << "\n----------   AST   ----------\n\n";
-    std::cout << program->debug(0);
+    ast::TextDumper out{std::cout};
+    program->dump(out);
     std::cout << "\n\n";
   }
 
@@ -63,6 +115,10 @@ shared_ptr<ast::ProgramStmt> parser::parse(vector<lexer::Token> &tokens) {
 shared_ptr<ast::ModuleStmt> parser::parse_module(Parser &parser) {
   auto mod = make_shared<ast::ModuleStmt>();
   mod->name = parser.file->file_path;
+  mod->file = parser.file;
+  parser.module = mod.get();
+  parser.arena = &mod->arena;
+  parser.lazy_bodies = LAZY_FN_BODIES;
 
   while (parser.has_tokens()) {
     try {
@@ -76,24 +132,203 @@ shared_ptr<ast::ModuleStmt> parser::parse_module(Parser &parser) {
   return mod;
 }
 
+shared_ptr<ast::ModuleStmt> parser::load_module(Parser &parser) {
+  if (AST_CACHE && parser.tokens.errs.size() == 0) {
+    if (auto mod = ast::load_cached_module(parser.file)) {
+      // Nothing was parsed, so the imports still have to be queued.
+      for (ast::Stmt *stmt : mod->body) {
+        if (stmt->kind == ast::IMPORT_STMT && parser.imports) {
+          parser.imports->schedule(static_cast<ast::ImportStmt *>(stmt)->path);
+        }
+      }
+
+      return mod;
+    }
+  }
+
+  auto mod = parse_module(parser);
+
+  // Parse errors never return here (see report) and lexing errors are checked, so only clean modules are cached and
+  // loading a snapshot never hides an error.
+  if (AST_CACHE && parser.tokens.errs.size() == 0) {
+    ast::store_cached_module(*mod);
+  }
+
+  return mod;
+}
+
+ast::BlockStmt *parser::fn_body(ast::FnDeclStmt *fn) {
+  if (fn->body) {
+    return fn->body;
+  }
+
+  if (fn->body_cached) {
+    return ast::load_cached_body(fn);
+  }
+
+  // The scanner keeps no state besides its position so lexing from the opening brace reproduces the body's tokens.
+  lexer::Lexer lex{fn->module->file};
+  lex.pos = fn->body_start;
+  lex.scan_until(fn->body_end);
+  lex.push(lexer::END_FILE, lex.pos, lex.pos);
+
+  lexer::TokenStream tokens{lex.tokens};
+  Parser parser{tokens};
+  parser.module = fn->module;
+  parser.arena = &fn->module->arena;
+
+  // skip_block lexed the body once already, so only a syntax error gets here.
+  try {
+    fn->body = parse_block_stmt(parser);
+  } catch (ParseAborted) {
+    throw *parser.error;
+  }
+
+  return fn->body;
+}
+
+// ---------------------
+// Module scheduling
+// ---------------------
+
+bool ModuleScheduler::claim(const string &path) {
+  std::lock_guard lock(manager->mutex);
+  return claimed.insert(path).second;
+}
+
+void ModuleScheduler::schedule(const string &path) {
+  {
+    std::lock_guard lock(manager->mutex);
+    if (!claimed.insert(path).second) {
+      return;
+    }
+
+    pending++;
+  }
+
+  pool.submit([this, path]() { parse(path); });
+}
+
+void ModuleScheduler::wait() {
+  std::unique_lock lock(manager->mutex);
+  finished.wait(lock, [this]() { return pending == 0; });
+}
+
+void ModuleScheduler::parse(string path) {
+  if (check_only) {
+    std::unordered_set<string> visiting;
+    if (summary(path, visiting)) {
+      std::lock_guard lock(manager->mutex);
+      if (--pending == 0) {
+        finished.notify_all();
+      }
+
+      return;
+    }
+  }
+
+  lexer::TokenStream tokens{path};
+  Parser parser{tokens};
+  parser.manager = manager;
+  parser.imports = this;
+
+  shared_ptr<ast::ModuleStmt> mod;
+  try {
+    mod = load_module(parser);
+  } catch (ParseAborted) {
+    // Handed to parse below, which reports every error once all modules are done.
+  }
+
+  std::lock_guard lock(manager->mutex);
+  lexing_errors.insert(lexing_errors.end(), tokens.errs.begin(), tokens.errs.end());
+  if (parser.error) {
+    manager->errors.push_back(*parser.error);
+  }
+
+  if (mod) {
+    manager->modules.insert_or_assign(path, mod);
+  }
+
+  if (--pending == 0) {
+    finished.notify_all();
+  }
+}
+
+shared_ptr<analysis::Interface> ModuleScheduler::summary(const string &path, std::unordered_set<string> &visiting) {
+  {
+    std::lock_guard lock(manager->mutex);
+    if (auto it = summaries.find(path); it != summaries.end()) {
+      return it->second;
+    }
+  }
+
+  if (!visiting.insert(path).second) {
+    return nullptr;
+  }
+
+  // Summaries are read outside the lock so modules are looked at in parallel. Two workers may load the same summary,
+  // which gives the same result either way.
+  auto iface = analysis::load_interface(path);
+  if (iface) {
+    for (const auto &[import, hash] : iface->imports) {
+      auto imported = summary(import, visiting);
+      if (!imported || analysis::exported_hash(*imported) != hash) {
+        iface = nullptr;
+        break;
+      }
+    }
+  }
+
+  visiting.erase(path);
+  std::lock_guard lock(manager->mutex);
+  return summaries.try_emplace(path, iface).first->second;
+}
+
+vector<shared_ptr<ast::ModuleStmt>> ModuleScheduler::ordered(shared_ptr<ast::ModuleStmt> entry) {
+  vector<shared_ptr<ast::ModuleStmt>> order;
+  std::unordered_set<ast::ModuleStmt *> visited;
+
+  std::function<void(shared_ptr<ast::ModuleStmt>)> visit = [&](shared_ptr<ast::ModuleStmt> mod) {
+    if (!visited.insert(mod.get()).second) {
+      return;
+    }
+
+    for (ast::Stmt *stmt : mod->body) {
+      if (stmt->kind != ast::IMPORT_STMT) {
+        continue;
+      }
+
+      auto it = manager->modules.find(static_cast<ast::ImportStmt *>(stmt)->path);
+      if (it != manager->modules.end()) {
+        visit(it->second);
+      }
+    }
+
+    order.push_back(mod);
+  };
+
+  visit(entry);
+  return order;
+}
+
 // ---------------------
 // Parser struct methods
 // ---------------------
 
 bool Parser::has_tokens() {
-  return this->pos < this->tokens.size() && this->current_tk_kind() != lexer::END_FILE;
+  return this->current_tk_kind() != lexer::END_FILE;
 }
 
-lexer::Token Parser::peak() {
-  return this->tokens.at(this->pos + 1);
+const lexer::Token &Parser::peak() {
+  return this->tokens.peek(1);
 }
 
-lexer::Token Parser::current_tk() {
-  return this->tokens.at(this->pos);
+const lexer::Token &Parser::current_tk() {
+  return this->tokens.peek();
 }
 
 lexer::TokenKind Parser::current_tk_kind() {
-  return this->current_tk().kind;
+  return this->tokens.peek().kind;
 }
 
 lexer::Token Parser::expect() {
@@ -111,30 +346,38 @@ lexer::Token Parser::advance() {
 }
 
 lexer::Token Parser::expect(lexer::TokenKind expected) {
-  auto tk = this->current_tk();
+  auto tk = this->tokens.advance();
 
-  this->pos++;
   if (tk.kind != expected) {
     auto err = Err(errors::UnexpectedToken);
     err.message("Expected to find " + bold_white(lexer::token_tag(expected)) + " but recieved " +
                 bold_white(lexer::token_tag(tk.kind)) + " instead.");
-    err.location(tk.pos);
+    err.location(this->location(tk));
     this->report(err);
   }
 
   return tk;
 }
 
+shared_ptr<lexer::SourcePos> Parser::location(const lexer::Token &tk) {
+  return this->tokens.pos(tk);
+}
+
+// Exiting here would tear down the interner and the pool while imports are still being parsed on it, so every parse
+// unwinds instead and parse reports the errors once all modules are done.
 void Parser::report(Err err) {
-  this->manager->errors.push_back(err);
-  err.display();
+  // A lexing error ends the token stream early, so whatever the parser trips over afterwards is a consequence of it.
+  // The lexing errors are reported instead.
+  if (this->tokens.errs.size() == 0) {
+    this->error.emplace(err);
+  }
 
   // TODO: Actualy propigate errors and catch multiple
-  exit(1);
-  throw err;
+  throw ParseAborted{};
 }
 
 optional<shared_ptr<ast::ModuleStmt>> Parser::get_module(string mod_name) {
+  std::lock_guard lock(this->manager->mutex);
   auto opt = optional<shared_ptr<ast::ModuleStmt>>{nullptr};
   auto it = this->manager->modules.find(mod_name);
 
@@ -146,6 +389,7 @@ optional<shared_ptr<ast::ModuleStmt>> Parser::get_module(string mod_name) {
 }
 
 shared_ptr<ast::ModuleStmt> Parser::add_module(string mod_name, shared_ptr<ast::ModuleStmt> mod) {
+  std::lock_guard lock(this->manager->mutex);
   this->manager->modules.insert_or_assign(mod_name, mod);
   return mod;
 }
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <unordered_set>
 
+#include "../analysis/interface.h"
 #include "../ast/ast.h"
 #include "../ast/ast_expr.h"
 #include "../ast/ast_macro.h"
@@ -9,87 +13,159 @@
 #include "../ast/ast_type.h"
 #include "../bedrock.h"
 #include "../lexing/lexer.h"
+#include "../util/thread_pool.h"
 #include "binding_power.h"
 
 namespace parser {
 
 // Parser Management
+/// @brief State shared by every parser of a program. Modules are parsed on several threads, so every access goes
+/// through the mutex.
 struct ParserManager {
+  std::mutex mutex;
   vector<errors::Err> errors;
-  unordered_map<string, shared_ptr<ast::ModuleStmt>> modules;
+  unordered_map<string, shared_ptr<ast::ModuleStmt>> modules; // keyed by resolved file path
 
   ParserManager() {
   }
 };
 
-struct Parser {
-  static shared_ptr<ParserManager> manager;
+/// @brief Thrown by Parser::report to unwind the parse of a module. Whoever started the parse finds the error in
+/// Parser::error.
+struct ParseAborted {};
+
+/// @brief Lexes and parses every module reachable from the entry on a thread pool. A module is queued the moment the
+/// import naming it is parsed, so a chain of imports costs the longest path through the graph rather than the sum of
+/// every module.
+struct ModuleScheduler {
+  utils::ThreadPool &pool;
+  shared_ptr<ParserManager> manager;
+  bool check_only = false; // imports with a current summary are left unbuilt, see summary
+
+  vector<errors::Err> lexing_errors; // lexing errors of the imported modules
+  // Every summary looked at, keyed by resolved file path. A module with a current summary is left unbuilt, so is any
+  // module its summary was checked against. nullptr for modules which are not current.
+  unordered_map<string, shared_ptr<analysis::Interface>> summaries;
+
+  ModuleScheduler(utils::ThreadPool &pool, shared_ptr<ParserManager> manager) : pool(pool), manager(manager) {
+  }
 
+  /// @brief Claims path for the caller, which parses it itself. Returns false when it was already claimed.
+  bool claim(const string &path);
+  /// @brief Queues path unless it was already claimed.
+  void schedule(const string &path);
+  /// @brief Blocks until every queued module has been parsed.
+  void wait();
+  /// @brief Every module reachable from entry. Imports come before the modules importing them, in source order, so the
+  /// result does not depend on which thread finished first.
+  vector<shared_ptr<ast::ModuleStmt>> ordered(shared_ptr<ast::ModuleStmt> entry);
+
+private:
+  std::condition_variable finished;
+  std::unordered_set<string> claimed;
+  size_t pending = 0;
+
+  void parse(string path);
+  /// @brief The stored summary of the module at path when it is current: its source is unchanged and so, transitively,
+  /// is every summary it was checked against. Nothing about such a module can have changed, so its tree is never
+  /// needed by a check. Modules inside an import cycle are never current. visiting holds the imports being followed.
+  shared_ptr<analysis::Interface> summary(const string &path, std::unordered_set<string> &visiting);
+};
+
+struct Parser {
+  shared_ptr<ParserManager> manager; // shared by every module of one parse, nullptr for a lone fn body
   shared_ptr<lexer::SourceFile> file;
-  vector<lexer::Token> tokens;
-  size_t pos;
+  lexer::TokenStream &tokens;
+  ast::ModuleStmt *module = nullptr; // module being parsed
+  ast::AstArena *arena = nullptr;    // arena of the module being parsed
+  bool lazy_bodies = false;          // skip function bodies, see fn_body
+  ModuleScheduler *imports = nullptr; // imports are not followed when nullptr
+  optional<Err> error;                // set by report, unless the parse stopped at a lexing error
 
   bool has_tokens();
-  lexer::Token peak();
-  lexer::Token current_tk();
+  /// @brief Returns the token after the current one. Valid until the parser advances past it.
+  const lexer::Token &peak();
+  /// @brief Returns the current token. Valid until the parser advances past it.
+  const lexer::Token &current_tk();
   lexer::TokenKind current_tk_kind();
   lexer::Token expect();
   lexer::Token expect(lexer::TokenKind);
   lexer::Token advance();
   bool advance_as(lexer::TokenKind);
 
+  /// @brief Returns the location of a token for error reporting.
+  shared_ptr<lexer::SourcePos> location(const lexer::Token &);
   void report(Err);
   optional<shared_ptr<ast::ModuleStmt>> get_module(string);
   shared_ptr<ast::ModuleStmt> add_module(string, shared_ptr<ast::ModuleStmt>);
 
-  Parser(vector<lexer::Token> &tokens) : tokens(tokens) {
+  /// @brief Allocates a node inside the arena of the module being parsed.
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    return arena->make<T>(std::forward<Args>(args)...);
+  }
+
+  Parser(lexer::TokenStream &tokens) : file(tokens.file), tokens(tokens) {
   }
 };
 
 // Public Methods
-shared_ptr<ast::ProgramStmt> parse(string file_path);
-shared_ptr<ast::ProgramStmt> parse(vector<lexer::Token> &tokens);
+/// @brief Parses the program starting at the entry file and every module it imports. Errors are displayed once every
+/// module is done, and nullptr is returned for a program which failed to lex or parse. With check_only the program is
+/// only going to be checked, so imports whose stored summary is current are not built at all and only their summary
+/// ends up in ProgramStmt::summaries. See ModuleScheduler::summary.
+shared_ptr<ast::ProgramStmt> parse(string file_path, bool check_only = false);
+shared_ptr<ast::ProgramStmt> parse(lexer::TokenBuffer &tokens, bool check_only = false);
+shared_ptr<ast::ProgramStmt> parse(lexer::TokenStream &tokens, bool check_only = false);
 shared_ptr<ast::ModuleStmt> parse_module(Parser &);
+/// @brief Loads the module from the AST cache when its source did not change since the snapshot was written. Otherwise
+/// parses it and refreshes the snapshot.
+shared_ptr<ast::ModuleStmt> load_module(Parser &);
+/// @brief Returns the body of fn. A body which was skipped by a lazy parse is lexed and parsed again from its recorded
+/// source range the first time it is asked for, one loaded from the AST cache is decoded from the snapshot. Bodies are
+/// built while modules are checked, possibly on the thread pool, so a body which fails to build throws its Err.
+ast::BlockStmt *fn_body(ast::FnDeclStmt *fn);
 
 // Stmt Parsing -----------
 // ------------------------
-shared_ptr<ast::Stmt> parse_stmt(Parser &);
-shared_ptr<ast::BlockStmt> parse_block_stmt(Parser &);
-shared_ptr<ast::ExprStmt> parse_expr_stmt(Parser &);
-shared_ptr<ast::StructStmt> parse_struct_stmt(Parser &);
-shared_ptr<ast::VarDeclStmt> parse_var_decl_stmt(Parser &);
-shared_ptr<ast::FnDeclStmt> parse_fn_decl_stmt(Parser &);
-shared_ptr<ast::ImplStmt> parse_impl_stmt(Parser &);
-shared_ptr<ast::DeferStmt> parse_defer_stmt(Parser &);
-shared_ptr<ast::ReturnStmt> parse_return_stmt(Parser &p);
+ast::Stmt *parse_stmt(Parser &);
+ast::BlockStmt *parse_block_stmt(Parser &);
+ast::ExprStmt *parse_expr_stmt(Parser &);
+ast::StructStmt *parse_struct_stmt(Parser &);
+ast::VarDeclStmt *parse_var_decl_stmt(Parser &);
+ast::FnDeclStmt *parse_fn_decl_stmt(Parser &);
+ast::ImplStmt *parse_impl_stmt(Parser &);
+ast::DeferStmt *parse_defer_stmt(Parser &);
+ast::ReturnStmt *parse_return_stmt(Parser &p);
+ast::ImportStmt *parse_import_stmt(Parser &p);
 
 // Expression Parsing -----
 // ------------------------
-shared_ptr<ast::Expr> parse_expr(Parser &, BindingPower);
-shared_ptr<ast::Expr> parse_primary_expr(Parser &);
-shared_ptr<ast::BinaryExpr> parse_binary_expr(Parser &, shared_ptr<ast::Expr>, BindingPower);
-shared_ptr<ast::AssignmentExpr> parse_assignment_expr(Parser &, shared_ptr<ast::Expr>, BindingPower);
-shared_ptr<ast::CallExpr> parse_call_expr(Parser &, shared_ptr<ast::Expr>, BindingPower);
-shared_ptr<ast::Expr> parse_grouping_expr(Parser &p);
-shared_ptr<ast::PrefixExpr> parse_prefix_expr(Parser &);
+ast::Expr *parse_expr(Parser &, BindingPower);
+ast::Expr *parse_primary_expr(Parser &);
+ast::BinaryExpr *parse_binary_expr(Parser &, ast::Expr *, BindingPower);
+ast::AssignmentExpr *parse_assignment_expr(Parser &, ast::Expr *, BindingPower);
+ast::CallExpr *parse_call_expr(Parser &, ast::Expr *, BindingPower);
+ast::Expr *parse_grouping_expr(Parser &p);
+ast::PrefixExpr *parse_prefix_expr(Parser &);
 
 // Type Parsing -----------
 // ------------------------
-shared_ptr<ast::Type> parse_type(Parser &, BindingPower);
-shared_ptr<ast::SymbolType> parse_symbol_type(Parser &);
-shared_ptr<ast::PointerType> parse_pointer_type(Parser &);
-shared_ptr<ast::FnType> parse_fn_type(Parser &);
+ast::Type *parse_type(Parser &, BindingPower);
+ast::SymbolType *parse_symbol_type(Parser &);
+ast::PointerType *parse_pointer_type(Parser &);
+ast::FnType *parse_fn_type(Parser &);
 
 // Macro & Trait Parsing -----
 // ------------------------
-shared_ptr<ast::LogMacro> parse_log_macro(Parser &);
-shared_ptr<ast::NumMacro> parse_num_macro(Parser &);
-shared_ptr<ast::StrMacro> parse_str_macro(Parser &);
-shared_ptr<ast::FmtMacro> parse_fmt_macro(Parser &);
+ast::LogMacro *parse_log_macro(Parser &);
+ast::NumMacro *parse_num_macro(Parser &);
+ast::StrMacro *parse_str_macro(Parser &);
+ast::FmtMacro *parse_fmt_macro(Parser &);
 
 // Shared Parsing Methods
+void skip_block(Parser &, ast::FnDeclStmt *);
 pair<vector<ast::PropertyKey>, bool> parse_fn_params(Parser &);
-vector<string> parse_generics_list(Parser &p);
-vector<shared_ptr<ast::Type>> parse_generic_type_list(Parser &p);
+vector<utils::SymbolId> parse_generics_list(Parser &p);
+vector<ast::Type *> parse_generic_type_list(Parser &p);
 
 }; // namespace parser
\ No newline at end of file
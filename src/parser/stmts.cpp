@@ -1,3 +1,5 @@
+#include <filesystem>
+
 #include "lookup.h"
 #include "parser.h"
 
@@ -5,25 +7,23 @@ using namespace parser;
 using namespace ast;
 using namespace lexer;
 
-shared_ptr<ast::Stmt> parser::parse_stmt(Parser &p) {
-  auto it = stmt_lu.find(p.current_tk_kind());
-
-  if (it != stmt_lu.end()) {
-    return stmt_lu.at(p.current_tk_kind())(p);
+ast::Stmt *parser::parse_stmt(Parser &p) {
+  if (stmt_handler handler = stmt_lu[p.current_tk_kind()]) {
+    return handler(p);
   }
 
   return parse_expr_stmt(p);
 }
 
-shared_ptr<ExprStmt> parser::parse_expr_stmt(Parser &p) {
-  auto expr_stmt = make_shared<ExprStmt>();
+ExprStmt *parser::parse_expr_stmt(Parser &p) {
+  auto expr_stmt = p.make<ExprStmt>();
   expr_stmt->expr = parse_expr(p, BindingPower::DEFAULT_BP);
   p.expect(lexer::SEMICOLON);
   return expr_stmt;
 }
 
-shared_ptr<ast::BlockStmt> parser::parse_block_stmt(Parser &p) {
-  auto block = make_shared<BlockStmt>();
+ast::BlockStmt *parser::parse_block_stmt(Parser &p) {
+  auto block = p.make<BlockStmt>();
 
   p.expect(lexer::OPEN_CURLY);
 
@@ -39,10 +39,10 @@ shared_ptr<ast::BlockStmt> parser::parse_block_stmt(Parser &p) {
   return block;
 }
 
-shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
-  auto stmt = make_shared<StructStmt>();
+ast::StructStmt *parser::parse_struct_stmt(Parser &p) {
+  auto stmt = p.make<StructStmt>();
   p.expect(STRUCT);
-  stmt->name = p.expect(IDENTIFIER).value;
+  stmt->name = p.expect(IDENTIFIER).symbol;
 
   // Handle generics
   if (p.current_tk_kind() == OPEN_GENERIC) {
@@ -53,8 +53,8 @@ shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
   while (p.has_tokens() && p.current_tk_kind() != CLOSE_CURLY) {
     bool pub = false;
     bool is_static = false;
-    string name;
-    shared_ptr<Type> type;
+    utils::SymbolId name;
+    Type *type;
 
     if (p.current_tk_kind() == PUB) {
       pub = true;
@@ -64,7 +64,7 @@ shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
         auto err = Err(ErrKind::InvalidStructDeclaration);
         err.message("Static methods/properties are already public.");
         err.hint("Remove the pub specifier for static methods/properties.");
-        err.location(p.current_tk().pos);
+        err.location(p.location(p.current_tk()));
         p.report(err);
       }
     }
@@ -76,13 +76,13 @@ shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
 
     // Handle Property Parsing
     if (p.current_tk_kind() == IDENTIFIER) {
-      name = p.expect(IDENTIFIER).value;
+      name = p.expect(IDENTIFIER).symbol;
 
       // Check for duplicate name
       if (stmt->public_status.find(name) != stmt->public_status.end()) {
         auto err = Err(ErrKind::InvalidStructDeclaration)
-                       .message("Duplicate field inside struct declaration " + red(name))
-                       .location(p.current_tk().pos);
+                       .message("Duplicate field inside struct declaration " + red(utils::symbol_name(name)))
+                       .location(p.location(p.current_tk()));
 
         p.report(err);
       }
@@ -97,7 +97,7 @@ shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
 
     auto err = Err(ErrKind::InvalidStructDeclaration);
     err.message("Unknown token inside struct declaration.");
-    err.location(p.current_tk().pos);
+    err.location(p.location(p.current_tk()));
     p.report(err);
   }
 
@@ -105,10 +105,10 @@ shared_ptr<ast::StructStmt> parser::parse_struct_stmt(Parser &p) {
   return stmt;
 }
 
-shared_ptr<ast::VarDeclStmt> parser::parse_var_decl_stmt(Parser &p) {
-  auto stmt = make_shared<VarDeclStmt>();
+ast::VarDeclStmt *parser::parse_var_decl_stmt(Parser &p) {
+  auto stmt = p.make<VarDeclStmt>();
   stmt->constant = p.advance_as(CONST);
-  stmt->varname = p.expect(IDENTIFIER).value;
+  stmt->varname = p.expect(IDENTIFIER).symbol;
 
   // Explicit Type
   if (p.current_tk_kind() == COLON) {
@@ -128,7 +128,7 @@ shared_ptr<ast::VarDeclStmt> parser::parse_var_decl_stmt(Parser &p) {
     err.message("Must provide value when declaring a constant.");
     err.hint("Please add a value to the constant declaration.");
     err.hint("If you dont want to provide a default value, use let instead.");
-    err.location(p.current_tk().pos);
+    err.location(p.location(p.current_tk()));
     p.report(err);
   }
 
@@ -136,9 +136,9 @@ shared_ptr<ast::VarDeclStmt> parser::parse_var_decl_stmt(Parser &p) {
   if (!stmt->constant && (!stmt->value && !stmt->type)) {
     auto err = Err(ErrKind::InvalidVariableDeclaration);
     err.message("Must specify a type or infer value for variable declaration.");
-    err.hint("ex: `let " + blue(stmt->varname) + ": " + green("Type") + ";`");
-    err.hint("ex: `let " + blue(stmt->varname) + " = " + green("Expr") + ";`");
-    err.location(p.current_tk().pos);
+    err.hint("ex: `let " + blue(utils::symbol_name(stmt->varname)) + ": " + green("Type") + ";`");
+    err.hint("ex: `let " + blue(utils::symbol_name(stmt->varname)) + " = " + green("Expr") + ";`");
+    err.location(p.location(p.current_tk()));
     p.report(err);
   }
 
@@ -146,31 +146,61 @@ shared_ptr<ast::VarDeclStmt> parser::parse_var_decl_stmt(Parser &p) {
   return stmt;
 }
 
-shared_ptr<ast::FnDeclStmt> parser::parse_fn_decl_stmt(Parser &p) {
-  auto stmt = make_shared<FnDeclStmt>();
+ast::FnDeclStmt *parser::parse_fn_decl_stmt(Parser &p) {
+  auto stmt = p.make<FnDeclStmt>();
   p.expect(FN);
-  stmt->name = p.expect(IDENTIFIER).value;
-  auto [params, _] = parse_fn_params(p);
+  stmt->name = p.expect(IDENTIFIER).symbol;
+  auto [params, variadic] = parse_fn_params(p);
   stmt->params = params;
+  stmt->variadic = variadic;
 
   if (p.current_tk_kind() == ARROW) {
     p.advance();
     stmt->return_type = parse_type(p, DEFAULT_BP);
   }
 
-  stmt->body = parse_block_stmt(p);
+  stmt->source_start = p.current_tk().offset;
+  if (p.lazy_bodies) {
+    skip_block(p, stmt);
+  } else {
+    stmt->body = parse_block_stmt(p);
+  }
+
+  stmt->source_end = p.current_tk().offset;
   return stmt;
 }
 
-shared_ptr<ast::ImplStmt> parser::parse_impl_stmt(Parser &p) {
-  auto stmt = make_shared<ImplStmt>();
+// Brace matches the body without building it. Strings and comments are already single tokens, so counting curly
+// tokens is enough.
+void parser::skip_block(Parser &p, ast::FnDeclStmt *fn) {
+  auto open = p.expect(OPEN_CURLY);
+  size_t depth = 1;
+
+  while (depth > 0 && p.has_tokens()) {
+    auto tk = p.advance();
+    depth += tk.kind == OPEN_CURLY;
+    depth -= tk.kind == CLOSE_CURLY;
+
+    if (depth == 0) {
+      fn->module = p.module;
+      fn->body_start = open.offset;
+      fn->body_end = tk.offset + tk.length;
+      return;
+    }
+  }
+
+  p.expect(CLOSE_CURLY);
+}
+
+ast::ImplStmt *parser::parse_impl_stmt(Parser &p) {
+  auto stmt = p.make<ImplStmt>();
   TODO("parse_impl not done");
   UNUSED(p);
   return stmt;
 }
 
-shared_ptr<ast::ReturnStmt> parser::parse_return_stmt(Parser &p) {
-  auto stmt = make_shared<ReturnStmt>();
+ast::ReturnStmt *parser::parse_return_stmt(Parser &p) {
+  auto stmt = p.make<ReturnStmt>();
   p.expect(lexer::RETURN);
 
   if (p.current_tk_kind() == lexer::SEMICOLON) {
@@ -182,8 +212,34 @@ shared_ptr<ast::ReturnStmt> parser::parse_return_stmt(Parser &p) {
   return stmt;
 }
 
-shared_ptr<ast::DeferStmt> parser::parse_defer_stmt(Parser &p) {
-  auto stmt = make_shared<DeferStmt>();
+// import("path") as name;
+// The path is relative to the importing file and gets a .br extension when it has none. The module is queued as soon
+// as the import is parsed so it is read while the rest of this module is still being parsed.
+ast::ImportStmt *parser::parse_import_stmt(Parser &p) {
+  auto stmt = p.make<ImportStmt>();
+  p.expect(IMPORT);
+  p.expect(OPEN_PAREN);
+  auto target = std::filesystem::path(string(p.expect(STRING).value));
+  p.expect(CLOSE_PAREN);
+  p.expect(AS);
+  stmt->alias = p.expect(IDENTIFIER).symbol;
+  p.expect(SEMICOLON);
+
+  if (!target.has_extension()) {
+    target += ".br";
+  }
+
+  stmt->path = (std::filesystem::path(p.file->file_path).parent_path() / target).lexically_normal().string();
+
+  if (p.imports) {
+    p.imports->schedule(stmt->path);
+  }
+
+  return stmt;
+}
+
+ast::DeferStmt *parser::parse_defer_stmt(Parser &p) {
+  auto stmt = p.make<DeferStmt>();
   p.expect(DEFER);
 
   // Handle defer block
@@ -201,12 +257,12 @@ shared_ptr<ast::DeferStmt> parser::parse_defer_stmt(Parser &p) {
   return stmt;
 }
 
-vector<string> parser::parse_generics_list(Parser &p) {
-  auto generics = vector<string>();
+vector<utils::SymbolId> parser::parse_generics_list(Parser &p) {
+  auto generics = vector<utils::SymbolId>();
   p.expect(OPEN_GENERIC);
 
   while (p.has_tokens() && p.current_tk_kind() != CLOSE_GENERIC) {
-    generics.push_back(p.expect(IDENTIFIER).value);
+    generics.push_back(p.expect(IDENTIFIER).symbol);
 
     if (p.current_tk_kind() != CLOSE_GENERIC) {
       p.expect(COMMA);
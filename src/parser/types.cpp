@@ -6,35 +6,31 @@ using namespace ast;
 using namespace lexer;
 
 type_nud_handler parser::get_type_nud(Parser &p) {
-  auto tk = p.current_tk();
-  auto it = type_nud_lu.find(tk.kind);
-
-  if (it != type_nud_lu.end()) {
-    return type_nud_lu.at(tk.kind);
+  const auto &tk = p.current_tk();
+  if (type_nud_handler handler = type_nud_lu[tk.kind]) {
+    return handler;
   }
 
-  auto err = bad_lu_handler_err("type_nud()", tk);
+  auto err = bad_lu_handler_err("type_nud()", p, tk);
   p.expect(); // advance past char since it has no null
   p.report(err);
   return nullptr;
 }
 
 type_led_handler parser::get_type_led(Parser &p) {
-  auto tk = p.current_tk();
-  auto it = type_led_lu.find(tk.kind);
-
-  if (it != type_led_lu.end()) {
-    return type_led_lu.at(tk.kind);
+  const auto &tk = p.current_tk();
+  if (type_led_handler handler = type_led_lu[tk.kind]) {
+    return handler;
   }
 
-  auto err = bad_lu_handler_err("type_led()", tk);
+  auto err = bad_lu_handler_err("type_led()", p, tk);
   p.expect(); // advance past char since it has no null
   p.report(err);
   return nullptr;
 }
 
-shared_ptr<Type> parser::parse_type(Parser &p, BindingPower bp) {
-  shared_ptr<Type> left;
+Type *parser::parse_type(Parser &p, BindingPower bp) {
+  Type *left;
   type_nud_handler nud = get_type_nud(p);
 
   left = nud(p);
@@ -47,26 +43,27 @@ shared_ptr<Type> parser::parse_type(Parser &p, BindingPower bp) {
   return left;
 }
 
-shared_ptr<SymbolType> parser::parse_symbol_type(Parser &p) {
-  auto symbol = make_shared<SymbolType>();
-  symbol->symbol = p.expect(lexer::IDENTIFIER).value;
+SymbolType *parser::parse_symbol_type(Parser &p) {
+  auto symbol = p.make<SymbolType>();
+  symbol->symbol = p.expect(lexer::IDENTIFIER).symbol;
   return symbol;
 }
 
-shared_ptr<PointerType> parser::parse_pointer_type(Parser &p) {
-  auto slice_type = make_shared<PointerType>();
+PointerType *parser::parse_pointer_type(Parser &p) {
+  auto slice_type = p.make<PointerType>();
   p.expect(AMPERSAND);
   slice_type->type = parse_type(p, DEFAULT_BP);
   return slice_type;
 }
 
-shared_ptr<FnType> parser::parse_fn_type(Parser &p) {
-  auto fn = make_shared<FnType>();
+FnType *parser::parse_fn_type(Parser &p) {
+  auto fn = p.make<FnType>();
   p.expect(lexer::FN);
   auto [params, variadic] = parse_fn_params(p);
 
   fn->params = params;
   fn->variadic = variadic;
+  fn->returns = p.make<SymbolType>(utils::intern("void")); // set default return
 
   if (p.current_tk_kind() == ARROW) {
     p.expect(ARROW);
@@ -87,7 +84,7 @@ pair<vector<PropertyKey>, bool> parser::parse_fn_params(Parser &p) {
 
     // Handle non variadic parameter
     if (p.current_tk_kind() != DYN) {
-      param.name = p.expect(IDENTIFIER).value;
+      param.name = p.expect(IDENTIFIER).symbol;
       p.expect(COLON);
       param.type = parse_type(p, DEFAULT_BP);
 
@@ -101,7 +98,7 @@ pair<vector<PropertyKey>, bool> parser::parse_fn_params(Parser &p) {
 
     TODO("Variadic function params");
     p.expect(DYN);
-    param.name = p.expect(IDENTIFIER).value;
+    param.name = p.expect(IDENTIFIER).symbol;
     param.variadic = true;
     p.expect(COLON);
     param.type = parse_type(p, DEFAULT_BP);
@@ -111,7 +108,7 @@ pair<vector<PropertyKey>, bool> parser::parse_fn_params(Parser &p) {
       err.message("expected closing parenthesis following declaration.");
       err.hint("Example: fn (a: T, b: T, dyn args: []T)");
       err.hint("Missing closing parenthesis following slice type.");
-      err.location(p.current_tk().pos);
+      err.location(p.location(p.current_tk()));
       p.report(err);
     }
 
@@ -123,8 +120,8 @@ pair<vector<PropertyKey>, bool> parser::parse_fn_params(Parser &p) {
   return make_pair(params, variadic);
 }
 
-vector<shared_ptr<ast::Type>> parser::parse_generic_type_list(Parser &p) {
-  vector<shared_ptr<ast::Type>> generics;
+vector<ast::Type *> parser::parse_generic_type_list(Parser &p) {
+  vector<ast::Type *> generics;
   p.expect(OPEN_GENERIC);
 
   while (p.has_tokens() && p.current_tk_kind() != CLOSE_GENERIC) {
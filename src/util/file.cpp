@@ -1,17 +1,29 @@
+#include <unistd.h>
+
+#include <filesystem>
 #include <fstream>
 
 #include "files.h"
 
-using std::istreambuf_iterator, std::ifstream;
+using std::ifstream;
 
 optional<string> utils::read_file_contents(const string &file_path) {
-  ifstream file(file_path);
+  ifstream file(file_path, std::ios::in | std::ios::binary);
 
   if (!file) {
     return std::nullopt;
   }
 
-  string contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  // Read in blocks. Works for pipes and other streams where the size is not known upfront.
+  const size_t BLOCK_SIZE = 64 * 1024;
+  string contents;
+
+  while (file) {
+    size_t length = contents.size();
+    contents.resize(length + BLOCK_SIZE);
+    file.read(contents.data() + length, BLOCK_SIZE);
+    contents.resize(length + (size_t)file.gcount());
+  }
 
   if (file.bad()) {
     return std::nullopt;
@@ -34,6 +46,26 @@ void utils::write_file_contents(const std::string &file_path, const std::string
   }
 }
 
+bool utils::write_file_atomic(const string &file_path, const string &data) {
+  std::error_code ec;
+  auto path = std::filesystem::path(file_path);
+  auto temp = path;
+  temp += "." + to_string(getpid()) + ".tmp";
+
+  std::filesystem::create_directories(path.parent_path(), ec);
+  {
+    std::ofstream file(temp, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.write(data.data(), data.size())) {
+      file.close();
+      std::filesystem::remove(temp, ec);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, path, ec);
+  return !ec;
+}
+
 std::string utils::sanitize_file_path(const std::string &file_path) {
   std::string result = file_path;
 
@@ -7,5 +7,8 @@ namespace utils {
 
 optional<string> read_file_contents(const string &file_path);
 void write_file_contents(const string &file_path, const string &data);
+/// @brief Writes data to a temporary file next to file_path and renames it over file_path, creating missing parent
+/// directories. Readers never see a half written file. Returns false when anything failed.
+bool write_file_atomic(const string &file_path, const string &data);
 std::string sanitize_file_path(const std::string &file_path);
 }; // namespace utils
\ No newline at end of file
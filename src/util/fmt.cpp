@@ -8,4 +8,37 @@ string utils::space(size_t padding) {
   }
 
   return str;
+}
+
+void utils::write_json_string(std::ostream &out, string_view s) {
+  static constexpr char HEX[] = "0123456789abcdef";
+  out << '"';
+
+  for (char c : s) {
+    switch (c) {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    case '\n':
+      out << "\\n";
+      break;
+    case '\t':
+      out << "\\t";
+      break;
+    case '\r':
+      out << "\\r";
+      break;
+    default:
+      if ((unsigned char)c < 0x20) {
+        out << "\\u00" << HEX[c >> 4] << HEX[c & 0xF];
+      } else {
+        out << c;
+      }
+    }
+  }
+
+  out << '"';
 }
\ No newline at end of file
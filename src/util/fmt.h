@@ -4,4 +4,6 @@
 
 namespace utils {
 string space(size_t padding);
+/// @brief Writes s to out as a quoted JSON string, escaping quotes, backslashes and control characters.
+void write_json_string(std::ostream &out, string_view s);
 };
\ No newline at end of file
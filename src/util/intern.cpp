@@ -0,0 +1,129 @@
+#include "intern.h"
+
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+
+using namespace utils;
+
+// Open addressed table of ids keyed by name. Names are copied into large blocks which are never freed or moved, so
+// the views in `names` stay valid for the life of the program. Lookups of names which already exist only take the
+// shared lock, so lexing threads rarely contend with each other.
+namespace {
+struct Slot {
+  uint32_t hash;
+  SymbolId id; // 0 marks an empty slot
+};
+
+const size_t BLOCK_SIZE = 64 * 1024;
+
+struct Interner {
+  std::shared_mutex mutex;
+  vector<string_view> names; // indexed by id
+  vector<Slot> slots;        // size is always a power of two
+  vector<std::unique_ptr<char[]>> blocks;
+  size_t block_used = 0;
+
+  Interner() {
+    names.emplace_back(); // id 0 is reserved
+    slots.resize(4096);
+  }
+
+  // Returns the slot holding name or the empty slot where it belongs.
+  Slot &find(string_view name, uint32_t hash) {
+    size_t mask = slots.size() - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot &slot = slots[i];
+
+      if (slot.id == 0 || (slot.hash == hash && names[slot.id] == name)) {
+        return slot;
+      }
+    }
+  }
+
+  string_view store(string_view name) {
+    // Names longer than a block get a block of their own. block_used then exceeds BLOCK_SIZE which forces the next
+    // name into a fresh block.
+    if (blocks.empty() || block_used + name.length() > BLOCK_SIZE) {
+      blocks.emplace_back(new char[std::max(BLOCK_SIZE, name.length())]);
+      block_used = 0;
+    }
+
+    char *dest = blocks.back().get() + block_used;
+    std::copy(name.begin(), name.end(), dest);
+    block_used += name.length();
+    return string_view(dest, name.length());
+  }
+
+  void grow() {
+    vector<Slot> old = std::move(slots);
+    slots.assign(old.size() * 2, Slot{0, 0});
+
+    for (const auto &slot : old) {
+      if (slot.id != 0) {
+        find(names[slot.id], slot.hash) = slot;
+      }
+    }
+  }
+};
+
+Interner &interner() {
+  static Interner instance;
+  return instance;
+}
+
+// FNV-1a. Identifiers are short so this beats the more elaborate std::hash.
+uint32_t hash_name(string_view name) {
+  uint32_t h = 2166136261u;
+
+  for (char c : name) {
+    h = (h ^ (uint8_t)c) * 16777619u;
+  }
+
+  return h;
+}
+}; // namespace
+
+SymbolId utils::intern(string_view name) {
+  Interner &in = interner();
+  uint32_t hash = hash_name(name);
+
+  {
+    std::shared_lock lock(in.mutex);
+    SymbolId id = in.find(name, hash).id;
+
+    if (id != 0) {
+      return id;
+    }
+  }
+
+  std::unique_lock lock(in.mutex);
+  Slot &slot = in.find(name, hash); // another thread may have inserted it between the two locks
+  if (slot.id != 0) {
+    return slot.id;
+  }
+
+  SymbolId id = (SymbolId)in.names.size();
+  in.names.push_back(in.store(name));
+  slot = Slot{hash, id};
+
+  // Keep the load factor under one half so probe sequences stay short.
+  if (in.names.size() * 2 > in.slots.size()) {
+    in.grow();
+  }
+
+  return id;
+}
+
+string_view utils::symbol_str(SymbolId id) {
+  Interner &in = interner();
+  std::shared_lock lock(in.mutex);
+  return in.names.at(id);
+}
+
+size_t utils::interned_count() {
+  Interner &in = interner();
+  std::shared_lock lock(in.mutex);
+  return in.names.size() - 1;
+}
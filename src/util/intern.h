@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../includes.h"
+
+namespace utils {
+
+/// @brief 32 bit handle to an interned identifier. Two names are equal exactly when their ids are equal.
+typedef uint32_t SymbolId;
+
+/// @brief Returns the id of name, adding it to the global interner the first time it is seen. Safe to call from any
+/// thread. Ids are handed out in first seen order starting from 1, 0 is never a valid id.
+SymbolId intern(string_view name);
+
+/// @brief Returns the text of an id handed out by intern(). The view stays valid for the life of the program.
+string_view symbol_str(SymbolId id);
+
+/// @brief Same as symbol_str() but copied into a string. Used when building diagnostics and debug output.
+inline string symbol_name(SymbolId id) {
+  return string(symbol_str(id));
+}
+
+/// @brief Number of distinct names interned so far.
+size_t interned_count();
+}; // namespace utils
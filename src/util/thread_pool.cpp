@@ -0,0 +1,52 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+using namespace utils;
+
+utils::ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < threads; i++) {
+    workers.emplace_back([this]() { work(); });
+  }
+}
+
+utils::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+
+  ready.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void utils::ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock lock(mutex);
+      ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+      if (queue.empty()) {
+        return; // stopping and nothing left to run
+      }
+
+      task = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    task();
+  }
+}
+
+ThreadPool &utils::thread_pool() {
+  static ThreadPool pool;
+  return pool;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "../includes.h"
+
+namespace utils {
+
+/// @brief Fixed size pool of worker threads fed from a single FIFO queue. Used to spread independent pieces of work,
+/// like the chunks of a large file, across cores.
+struct ThreadPool {
+  /// @brief Starts `threads` workers. 0 uses one worker per hardware thread.
+  ThreadPool(size_t threads = 0);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  /// @brief Finishes every queued task and joins the workers.
+  ~ThreadPool();
+
+  size_t size() const {
+    return workers.size();
+  }
+
+  /// @brief Queues fn and returns a future for its result. Exceptions thrown by fn are rethrown by future::get().
+  template <typename Fn> auto submit(Fn fn) -> std::future<decltype(fn())> {
+    auto task = std::make_shared<std::packaged_task<decltype(fn())()>>(std::move(fn));
+    auto result = task->get_future();
+
+    {
+      std::lock_guard lock(mutex);
+      queue.emplace_back([task]() { (*task)(); });
+    }
+
+    ready.notify_one();
+    return result;
+  }
+
+private:
+  vector<std::thread> workers;
+  std::deque<std::function<void()>> queue;
+  std::mutex mutex;
+  std::condition_variable ready;
+  bool stopping = false;
+
+  void work();
+};
+
+/// @brief Process wide pool shared by every stage of the compiler. Created on first use.
+ThreadPool &thread_pool();
+}; // namespace utils
@@ -3,6 +3,7 @@
 #include "./colors.h"
 #include "files.h"
 #include "fmt.h"
+#include "intern.h"
 
 #include <regex>
 